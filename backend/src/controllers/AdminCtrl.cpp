@@ -1,136 +1,161 @@
 #include "AdminCtrl.h"
 #include "SupabaseHelper.h"
+#include "RatingStore.h"
 #include <fstream>
 
-bool AdminCtrl::isAdmin(const std::string &email) {
+void AdminCtrl::isAdmin(const std::string &email, std::function<void (bool)> &&done) {
     // Check admin status from Supabase database
-    bool isAdminUser = false;
-    std::string err;
-    if(!SupabaseHelper::getUserAdminStatus(email, isAdminUser, err)) {
-        LOG_ERROR << "Failed to check admin status for " << email << ": " << err;
-        return false; // Fail closed - if we can't verify, deny access
-    }
-    return isAdminUser;
+    SupabaseHelper::getUserAdminStatus(email, [email, done = std::move(done)](bool ok, bool isAdminUser, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to check admin status for " << email << ": " << err;
+            done(false); // Fail closed - if we can't verify, deny access
+            return;
+        }
+        done(isAdminUser);
+    });
 }
 
-void AdminCtrl::getReported(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+void AdminCtrl::requireAdmin(const drogon::HttpRequestPtr &req,
+                             std::function<void (const drogon::HttpResponsePtr &)> &&cb,
+                             std::function<void (std::function<void (const drogon::HttpResponsePtr &)> &&)> &&onAdmin) {
     auto authHeader = req->getHeader("authorization");
     auto email = parseToken(authHeader);
-    if(email.empty() || !isAdmin(email)) {
+    auto unauthorized = [](const std::function<void (const drogon::HttpResponsePtr &)> &cb) {
         auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
         resp->setStatusCode(drogon::k401Unauthorized);
         (*resp->getJsonObject())["error"] = "missing/invalid token or not admin";
         cb(resp);
+    };
+    if(email.empty()) {
+        unauthorized(cb);
         return;
     }
 
-    Json::Value reportsArray;
-    std::string err;
-    if(!SupabaseHelper::getAllReportedReviews(reportsArray, err)) {
-        LOG_ERROR << "Failed to get reported reviews: " << err;
-        // Return 200 with empty array - endpoint exists but query failed
-        // This prevents frontend from thinking endpoint is missing
-        Json::Value root(Json::objectValue);
-        root["reports"] = Json::Value(Json::arrayValue);
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(root);
-        resp->setStatusCode(drogon::k200OK);
-        cb(resp);
-        return;
-    }
+    isAdmin(email, [cb = std::move(cb), onAdmin = std::move(onAdmin), unauthorized](bool admin) mutable {
+        if(!admin) {
+            unauthorized(cb);
+            return;
+        }
+        onAdmin(std::move(cb));
+    });
+}
+
+void AdminCtrl::getReported(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+    requireAdmin(req, std::move(cb), [](std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+        SupabaseHelper::getAllReportedReviews([cb = std::move(cb)](bool ok, const Json::Value &reportsArray, const std::string &err) {
+            if(!ok) {
+                LOG_ERROR << "Failed to get reported reviews: " << err;
+                // Return 200 with empty array - endpoint exists but query failed
+                // This prevents frontend from thinking endpoint is missing
+                Json::Value root(Json::objectValue);
+                root["reports"] = Json::Value(Json::arrayValue);
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(root);
+                resp->setStatusCode(drogon::k200OK);
+                cb(resp);
+                return;
+            }
 
-    Json::Value root(Json::objectValue);
-    root["reports"] = reportsArray;
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(root);
-    cb(resp);
+            Json::Value root(Json::objectValue);
+            root["reports"] = reportsArray;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(root);
+            cb(resp);
+        });
+    });
 }
 
 void AdminCtrl::approve(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb, const std::string &id) {
-    auto authHeader = req->getHeader("authorization");
-    auto email = parseToken(authHeader);
-    if(email.empty() || !isAdmin(email)) {
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k401Unauthorized);
-        (*resp->getJsonObject())["error"] = "missing/invalid token or not admin";
-        cb(resp);
-        return;
-    }
+    requireAdmin(req, std::move(cb), [id](std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+        // Get the report to find the review_id
+        SupabaseHelper::getAllReportedReviews([cb = std::move(cb), id](bool ok, const Json::Value &reportsArray, const std::string &err) {
+            if(!ok) {
+                LOG_ERROR << "Failed to get reported reviews: " << err;
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                resp->setStatusCode(drogon::k500InternalServerError);
+                (*resp->getJsonObject())["error"] = "Failed to load reports: " + err;
+                cb(resp);
+                return;
+            }
 
-    // Get the report to find the review_id
-    Json::Value reportsArray;
-    std::string err;
-    if(!SupabaseHelper::getAllReportedReviews(reportsArray, err)) {
-        LOG_ERROR << "Failed to get reported reviews: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to load reports: " + err;
-        cb(resp);
-        return;
-    }
+            std::string removedReviewId;
+            bool found = false;
+            for(const auto &r : reportsArray) {
+                if(r["id"].asString() == id) {
+                    removedReviewId = r.get("review_id", "").asString();
+                    found = true;
+                    break;
+                }
+            }
 
-    std::string removedReviewId;
-    bool found = false;
-    for(const auto &r : reportsArray) {
-        if(r["id"].asString() == id) {
-            removedReviewId = r.get("review_id", "").asString();
-            found = true;
-            break;
-        }
-    }
+            if(!found) {
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                resp->setStatusCode(drogon::k404NotFound);
+                (*resp->getJsonObject())["error"] = "report not found";
+                cb(resp);
+                return;
+            }
 
-    if(!found) {
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k404NotFound);
-        (*resp->getJsonObject())["error"] = "report not found";
-        cb(resp);
-        return;
-    }
-
-    // Delete the report
-    if(!SupabaseHelper::deleteReportedReview(id, err)) {
-        LOG_ERROR << "Failed to delete report: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to delete report: " + err;
-        cb(resp);
-        return;
-    }
+            // Delete the report
+            SupabaseHelper::deleteReportedReview(id, [cb, removedReviewId](bool ok, const std::string &err) {
+                if(!ok) {
+                    LOG_ERROR << "Failed to delete report: " << err;
+                    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                    resp->setStatusCode(drogon::k500InternalServerError);
+                    (*resp->getJsonObject())["error"] = "Failed to delete report: " + err;
+                    cb(resp);
+                    return;
+                }
 
-    // Delete the review if review_id was found
-    if(!removedReviewId.empty()) {
-        if(!SupabaseHelper::deleteReview(removedReviewId, err)) {
-            LOG_ERROR << "Failed to delete review " << removedReviewId << ": " << err;
-            // Continue anyway - report was deleted
-        }
-    }
+                auto respond = [cb]() {
+                    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                    (*resp->getJsonObject())["message"] = "report approved and review removed";
+                    cb(resp);
+                };
 
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-    (*resp->getJsonObject())["message"] = "report approved and review removed";
-    cb(resp);
+                // Delete the review if review_id was found
+                if(removedReviewId.empty()) {
+                    respond();
+                    return;
+                }
+                SupabaseHelper::deleteReview(removedReviewId, [removedReviewId, respond](bool ok, const Json::Value &deleted, const std::string &err) {
+                    if(!ok) {
+                        LOG_ERROR << "Failed to delete review " << removedReviewId << ": " << err;
+                        // Continue anyway - report was deleted
+                    }
+                    for(const auto &row : deleted) {
+                        RatingStore::instance().removeReview(row["id"].asString(), row["landlord_id"].asString(), row["rating"].asInt());
+                    }
+                    respond();
+                });
+            });
+        });
+    });
 }
 
 void AdminCtrl::deny(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb, const std::string &id) {
-    auto authHeader = req->getHeader("authorization");
-    auto email = parseToken(authHeader);
-    if(email.empty() || !isAdmin(email)) {
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k401Unauthorized);
-        (*resp->getJsonObject())["error"] = "missing/invalid token or not admin";
-        cb(resp);
-        return;
-    }
+    requireAdmin(req, std::move(cb), [id](std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+        // Delete the report from Supabase
+        SupabaseHelper::deleteReportedReview(id, [cb = std::move(cb)](bool ok, const std::string &err) {
+            if(!ok) {
+                LOG_ERROR << "Failed to delete report: " << err;
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                resp->setStatusCode(drogon::k500InternalServerError);
+                (*resp->getJsonObject())["error"] = "Failed to delete report: " + err;
+                cb(resp);
+                return;
+            }
 
-    // Delete the report from Supabase
-    std::string err;
-    if(!SupabaseHelper::deleteReportedReview(id, err)) {
-        LOG_ERROR << "Failed to delete report: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to delete report: " + err;
-        cb(resp);
-        return;
-    }
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            (*resp->getJsonObject())["message"] = "report removed (denied)";
+            cb(resp);
+        });
+    });
+}
 
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-    (*resp->getJsonObject())["message"] = "report removed (denied)";
-    cb(resp);
+void AdminCtrl::supabaseStats(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+    requireAdmin(req, std::move(cb), [](std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+        Json::Value stats;
+        SupabaseHelper::getConnectionStats(stats);
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(stats);
+        cb(resp);
+    });
 }
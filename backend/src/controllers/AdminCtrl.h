@@ -12,6 +12,7 @@ public:
     void getReported(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb);
     void approve(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb, const std::string &id);
     void deny(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb, const std::string &id);
+    void supabaseStats(const drogon::HttpRequestPtr &req, std::function<void (const drogon::HttpResponsePtr &)> &&cb);
 
 private:
     std::string reportedPath_;
@@ -25,5 +26,10 @@ private:
         if(token.rfind("demo::", 0) != 0) return "";
         return token.substr(6);
     }
-    bool isAdmin(const std::string &email);
+    // Calls done with true only if Supabase confirms the user is an admin
+    void isAdmin(const std::string &email, std::function<void (bool)> &&done);
+    // Responds 401 unless the bearer token belongs to an admin; otherwise hands cb to onAdmin
+    void requireAdmin(const drogon::HttpRequestPtr &req,
+                      std::function<void (const drogon::HttpResponsePtr &)> &&cb,
+                      std::function<void (std::function<void (const drogon::HttpResponsePtr &)> &&)> &&onAdmin);
 };
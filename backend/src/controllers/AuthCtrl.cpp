@@ -233,52 +233,52 @@ void AuthCtrl::requestVerification(const drogon::HttpRequestPtr &req,
     }
 
     // Check if email exists in Supabase database
-    bool supabaseExists = false;
-    std::string supabaseCheckErr;
-    if(!SupabaseHelper::checkUserExists(email, supabaseExists, supabaseCheckErr)) {
-        LOG_ERROR << "Failed to check Supabase for " << email << ": " << supabaseCheckErr;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "database check failed: " + supabaseCheckErr;
-        cb(resp);
-        return;
-    }
-    if(supabaseExists) {
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k409Conflict);
-        (*resp->getJsonObject())["error"] = "user already exists";
-        cb(resp);
-        return;
-    }
+    SupabaseHelper::checkUserExists(email, [this, email, cb = std::move(cb)](bool ok, bool supabaseExists, const std::string &supabaseCheckErr) {
+        if(!ok) {
+            LOG_ERROR << "Failed to check Supabase for " << email << ": " << supabaseCheckErr;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "database check failed: " + supabaseCheckErr;
+            cb(resp);
+            return;
+        }
+        if(supabaseExists) {
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k409Conflict);
+            (*resp->getJsonObject())["error"] = "user already exists";
+            cb(resp);
+            return;
+        }
 
-    // Step 1: Now that we have confirmed we can proceed with the account creation, start by generating a verification code.
-    const std::string code = generateVerificationCode();
+        // Step 1: Now that we have confirmed we can proceed with the account creation, start by generating a verification code.
+        const std::string code = generateVerificationCode();
 
-    std::string mailErr;
-    if(!sendVerificationEmail(email, code, mailErr)) {
-        LOG_ERROR << "Failed to send verification email to " << email << ": " << mailErr;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "failed to send verification email";
-        cb(resp);
-        return;
-    }
+        std::string mailErr;
+        if(!sendVerificationEmail(email, code, mailErr)) {
+            LOG_ERROR << "Failed to send verification email to " << email << ": " << mailErr;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "failed to send verification email";
+            cb(resp);
+            return;
+        }
 
-    // Step 2: Wait for user to enter verification code
-    {
-        std::lock_guard<std::mutex> lk(mu_);
-        pendingVerifications_[email] = PendingVerification{
-            code,
-            std::chrono::steady_clock::now() + kVerificationLifetime,
-            false
-        };
-    }
+        // Step 2: Wait for user to enter verification code
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            pendingVerifications_[email] = PendingVerification{
+                code,
+                std::chrono::steady_clock::now() + kVerificationLifetime,
+                false
+            };
+        }
 
-    LOG_INFO << "Verification code emailed to " << email;
+        LOG_INFO << "Verification code emailed to " << email;
 
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-    (*resp->getJsonObject())["message"] = "verification code sent";
-    cb(resp);
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+        (*resp->getJsonObject())["message"] = "verification code sent";
+        cb(resp);
+    });
 }
 
 
@@ -369,49 +369,51 @@ void AuthCtrl::login(const drogon::HttpRequestPtr &req,
     std::string password = (*json)["password"].asString();
 
     // Fetch user data from Supabase database
-    std::string password_hashed;
-    std::string password_plain;
-    std::string name;
-    int admin = 0;
-    std::string err;
-    if(!SupabaseHelper::getUserPasswordHash(email, password_hashed, password_plain, name, admin, err)) {
-        LOG_ERROR << "Failed to get user password hash for " << email << ": " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k401Unauthorized);
-        (*resp->getJsonObject())["error"] = "invalid credentials";
-        cb(resp);
-        return;
-    }
+    SupabaseHelper::getUserPasswordHash(email, [email, password, cb = std::move(cb)](bool found, const Json::Value &user, const std::string &err) {
+        if(!found) {
+            LOG_ERROR << "Failed to get user password hash for " << email << ": " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k401Unauthorized);
+            (*resp->getJsonObject())["error"] = "invalid credentials";
+            cb(resp);
+            return;
+        }
 
-    // HASH secure verification + legacy upgrade
-    bool ok = false;
+        std::string password_hashed = user.get("password_hashed", "").asString();
+        std::string password_plain = user.get("password_plain", "").asString();
+        std::string name = user.get("name", "").asString();
+        int admin = user.get("admin", 0).asInt();
+
+        // HASH secure verification + legacy upgrade
+        bool ok = false;
+
+        if (!password_hashed.empty() && AuthCtrl::isArgon2idEncoded(password_hashed)) {
+            // Preferred path: verify against Argon2id PHC
+            ok = AuthCtrl::verifyPassword(password, password_hashed);
+        } else {
+            // Legacy path: allow one-time plaintext match (demo)
+            if (!password_plain.empty() && password_plain == password) {
+                ok = true;
+            }
+        }
 
-    if (!password_hashed.empty() && AuthCtrl::isArgon2idEncoded(password_hashed)) {
-        // Preferred path: verify against Argon2id PHC
-        ok = AuthCtrl::verifyPassword(password, password_hashed);
-    } else {
-        // Legacy path: allow one-time plaintext match (demo)
-        if (!password_plain.empty() && password_plain == password) {
-            ok = true;
+        if (!ok) {
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k401Unauthorized);
+            (*resp->getJsonObject())["error"] = "invalid credentials";
+            cb(resp);
+            return;
         }
-    }
 
-    if (!ok) {
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k401Unauthorized);
-        (*resp->getJsonObject())["error"] = "invalid credentials";
+        // Now we have passed all the login checks (Is there data? and Is the data in the database?), we can now confirm the request. 
+        Json::Value payload(Json::objectValue);
+        payload["token"] = makeToken(email);
+        payload["name"] = name;
+        payload["email"] = email;
+        payload["admin"] = admin;
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(payload);
         cb(resp);
-        return;
-    }
-
-    // Now we have passed all the login checks (Is there data? and Is the data in the database?), we can now confirm the request. 
-    Json::Value payload(Json::objectValue);
-    payload["token"] = makeToken(email);
-    payload["name"] = name;
-    payload["email"] = email;
-    payload["admin"] = admin;
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(payload);
-    cb(resp);
+    });
 }
 
 void AuthCtrl::signup(const drogon::HttpRequestPtr &req,
@@ -461,46 +463,47 @@ void AuthCtrl::signup(const drogon::HttpRequestPtr &req,
     }
 
     // Check if email exists in Supabase database (required)
-    bool supabaseExists = false;
-    std::string supabaseCheckErr;
-    if(!SupabaseHelper::checkUserExists(email, supabaseExists, supabaseCheckErr)) {
-        LOG_ERROR << "Failed to check Supabase for " << email << ": " << supabaseCheckErr;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "database check failed: " + supabaseCheckErr;
-        cb(resp);
-        return;
-    }
-    if(supabaseExists) {
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k409Conflict);
-        (*resp->getJsonObject())["error"] = "user already exists";
-        cb(resp);
-        return;
-    }
+    SupabaseHelper::checkUserExists(email, [this, email, name, password, encoded, cb = std::move(cb)](bool ok, bool supabaseExists, const std::string &supabaseCheckErr) {
+        if(!ok) {
+            LOG_ERROR << "Failed to check Supabase for " << email << ": " << supabaseCheckErr;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "database check failed: " + supabaseCheckErr;
+            cb(resp);
+            return;
+        }
+        if(supabaseExists) {
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k409Conflict);
+            (*resp->getJsonObject())["error"] = "user already exists";
+            cb(resp);
+            return;
+        }
 
-    // Insert user into Supabase database
-    std::string supabaseErr;
-    if(!SupabaseHelper::insertUser(email, name, password, encoded, 0, supabaseErr)) {
-        LOG_ERROR << "Supabase sync failed for " << email << ": " << supabaseErr;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "internal error (supabase sync)";
-        cb(resp);
-        return;
-    }
+        // Insert user into Supabase database
+        SupabaseHelper::insertUser(email, name, password, encoded, 0, [this, email, name, cb](bool ok, const std::string &supabaseErr) {
+            if(!ok) {
+                LOG_ERROR << "Supabase sync failed for " << email << ": " << supabaseErr;
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                resp->setStatusCode(drogon::k500InternalServerError);
+                (*resp->getJsonObject())["error"] = "internal error (supabase sync)";
+                cb(resp);
+                return;
+            }
 
-    {
-        std::lock_guard<std::mutex> lk(mu_);
-        pendingVerifications_.erase(email);
-    }
-    Json::Value payload(Json::objectValue);
-    payload["token"] = makeToken(email);
-    payload["name"] = name;
-    payload["email"] = email;
-    payload["admin"] = 0;
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(payload);
-    cb(resp);
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                pendingVerifications_.erase(email);
+            }
+            Json::Value payload(Json::objectValue);
+            payload["token"] = makeToken(email);
+            payload["name"] = name;
+            payload["email"] = email;
+            payload["admin"] = 0;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(payload);
+            cb(resp);
+        });
+    });
 }
 
 bool AuthCtrl::hashPassword(const std::string &plain, std::string &encoded) {
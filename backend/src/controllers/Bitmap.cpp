@@ -0,0 +1,193 @@
+#include "Bitmap.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    const size_t WORDS = 65536 / 64;
+
+    uint32_t popcount(uint64_t word) {
+        return static_cast<uint32_t>(__builtin_popcountll(word));
+    }
+}
+
+bool Bitmap::Chunk::contains(uint16_t low) const {
+    if(dense()) return (bits[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void Bitmap::Chunk::add(uint16_t low) {
+    if(dense()) {
+        uint64_t bit = uint64_t(1) << (low & 63);
+        if(!(bits[low >> 6] & bit)) {
+            bits[low >> 6] |= bit;
+            count++;
+        }
+        return;
+    }
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if(it != array.end() && *it == low) return;
+    array.insert(it, low);
+    count++;
+    if(count > ARRAY_LIMIT) makeDense();
+}
+
+void Bitmap::Chunk::makeDense() {
+    bits.assign(WORDS, 0);
+    for(uint16_t low : array) bits[low >> 6] |= uint64_t(1) << (low & 63);
+    std::vector<uint16_t>().swap(array);
+}
+
+void Bitmap::append(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    if(chunks_.empty() || chunks_.back().key != key) {
+        chunks_.emplace_back();
+        chunks_.back().key = key;
+    }
+    chunks_.back().add(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+uint32_t Bitmap::cardinality() const {
+    uint32_t total = 0;
+    for(const auto &chunk : chunks_) total += chunk.count;
+    return total;
+}
+
+Bitmap::Chunk Bitmap::andChunks(const Chunk &a, const Chunk &b) {
+    Chunk result;
+    result.key = a.key;
+    if(a.dense() && b.dense()) {
+        result.bits.resize(WORDS);
+        for(size_t w = 0; w < WORDS; w++) {
+            result.bits[w] = a.bits[w] & b.bits[w];
+            result.count += popcount(result.bits[w]);
+        }
+        // Fall back to an array if the intersection turned sparse
+        if(result.count <= ARRAY_LIMIT) {
+            for(size_t w = 0; w < WORDS; w++) {
+                for(uint64_t word = result.bits[w]; word; word &= word - 1) {
+                    result.array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+                }
+            }
+            std::vector<uint64_t>().swap(result.bits);
+        }
+    } else if(a.dense() || b.dense()) {
+        const Chunk &sparse = a.dense() ? b : a;
+        const Chunk &dense = a.dense() ? a : b;
+        for(uint16_t low : sparse.array) {
+            if(dense.contains(low)) result.array.push_back(low);
+        }
+        result.count = static_cast<uint32_t>(result.array.size());
+    } else {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(result.array));
+        result.count = static_cast<uint32_t>(result.array.size());
+    }
+    return result;
+}
+
+Bitmap::Chunk Bitmap::orChunks(const Chunk &a, const Chunk &b) {
+    Chunk result;
+    result.key = a.key;
+    if(!a.dense() && !b.dense() && a.count + b.count <= ARRAY_LIMIT) {
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                       std::back_inserter(result.array));
+        result.count = static_cast<uint32_t>(result.array.size());
+        return result;
+    }
+    result.bits.assign(WORDS, 0);
+    for(const Chunk *chunk : {&a, &b}) {
+        if(chunk->dense()) {
+            for(size_t w = 0; w < WORDS; w++) result.bits[w] |= chunk->bits[w];
+        } else {
+            for(uint16_t low : chunk->array) result.bits[low >> 6] |= uint64_t(1) << (low & 63);
+        }
+    }
+    for(uint64_t word : result.bits) result.count += popcount(word);
+    if(result.count <= ARRAY_LIMIT) {
+        for(size_t w = 0; w < WORDS; w++) {
+            for(uint64_t word = result.bits[w]; word; word &= word - 1) {
+                result.array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+            }
+        }
+        std::vector<uint64_t>().swap(result.bits);
+    }
+    return result;
+}
+
+uint32_t Bitmap::andChunkCount(const Chunk &a, const Chunk &b) {
+    uint32_t count = 0;
+    if(a.dense() && b.dense()) {
+        for(size_t w = 0; w < WORDS; w++) count += popcount(a.bits[w] & b.bits[w]);
+    } else if(a.dense() || b.dense()) {
+        const Chunk &sparse = a.dense() ? b : a;
+        const Chunk &dense = a.dense() ? a : b;
+        for(uint16_t low : sparse.array) count += dense.contains(low);
+    } else {
+        auto i = a.array.begin();
+        auto j = b.array.begin();
+        while(i != a.array.end() && j != b.array.end()) {
+            if(*i < *j) ++i;
+            else if(*j < *i) ++j;
+            else { count++; ++i; ++j; }
+        }
+    }
+    return count;
+}
+
+Bitmap Bitmap::operator&(const Bitmap &other) const {
+    Bitmap result;
+    size_t i = 0, j = 0;
+    while(i < chunks_.size() && j < other.chunks_.size()) {
+        if(chunks_[i].key < other.chunks_[j].key) i++;
+        else if(other.chunks_[j].key < chunks_[i].key) j++;
+        else {
+            Chunk chunk = andChunks(chunks_[i++], other.chunks_[j++]);
+            if(chunk.count > 0) result.chunks_.push_back(std::move(chunk));
+        }
+    }
+    return result;
+}
+
+Bitmap Bitmap::operator|(const Bitmap &other) const {
+    Bitmap result;
+    size_t i = 0, j = 0;
+    while(i < chunks_.size() || j < other.chunks_.size()) {
+        if(j == other.chunks_.size() || (i < chunks_.size() && chunks_[i].key < other.chunks_[j].key)) {
+            result.chunks_.push_back(chunks_[i++]);
+        } else if(i == chunks_.size() || other.chunks_[j].key < chunks_[i].key) {
+            result.chunks_.push_back(other.chunks_[j++]);
+        } else {
+            result.chunks_.push_back(orChunks(chunks_[i++], other.chunks_[j++]));
+        }
+    }
+    return result;
+}
+
+uint32_t Bitmap::andCardinality(const Bitmap &other) const {
+    uint32_t count = 0;
+    size_t i = 0, j = 0;
+    while(i < chunks_.size() && j < other.chunks_.size()) {
+        if(chunks_[i].key < other.chunks_[j].key) i++;
+        else if(other.chunks_[j].key < chunks_[i].key) j++;
+        else count += andChunkCount(chunks_[i++], other.chunks_[j++]);
+    }
+    return count;
+}
+
+std::vector<uint32_t> Bitmap::values() const {
+    std::vector<uint32_t> out;
+    out.reserve(cardinality());
+    for(const auto &chunk : chunks_) {
+        uint32_t high = static_cast<uint32_t>(chunk.key) << 16;
+        if(chunk.dense()) {
+            for(size_t w = 0; w < WORDS; w++) {
+                for(uint64_t word = chunk.bits[w]; word; word &= word - 1) {
+                    out.push_back(high | static_cast<uint32_t>(w * 64 + __builtin_ctzll(word)));
+                }
+            }
+        } else {
+            for(uint16_t low : chunk.array) out.push_back(high | low);
+        }
+    }
+    return out;
+}
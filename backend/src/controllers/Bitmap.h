@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/*
+    What is a Bitmap?
+    A compressed set of uint32_t values in the style of Roaring bitmaps. Values are split by
+    their high 16 bits into chunks; a chunk holding few values keeps them as a sorted array
+    of their low 16 bits, and a dense chunk switches to a fixed 65536-bit bitset. Sparse
+    and dense sets both stay small, and AND/OR work chunk by chunk.
+*/
+class Bitmap {
+public:
+    // Add a value; values must be added in increasing order
+    void append(uint32_t value);
+
+    uint32_t cardinality() const;
+    bool empty() const { return chunks_.empty(); }
+
+    Bitmap operator&(const Bitmap &other) const;
+    Bitmap operator|(const Bitmap &other) const;
+
+    // Size of the intersection, without building it
+    uint32_t andCardinality(const Bitmap &other) const;
+
+    // Every value, in increasing order
+    std::vector<uint32_t> values() const;
+
+private:
+    // Chunks switch to a bitset once an array would take more room than one
+    static constexpr uint32_t ARRAY_LIMIT = 4096;
+
+    struct Chunk {
+        uint16_t key = 0;                   // high 16 bits of the values
+        uint32_t count = 0;
+        std::vector<uint16_t> array;        // sorted low bits, while count <= ARRAY_LIMIT
+        std::vector<uint64_t> bits;         // 1024 words once the chunk is dense
+
+        bool dense() const { return !bits.empty(); }
+        bool contains(uint16_t low) const;
+        void add(uint16_t low);
+        void makeDense();
+    };
+
+    static Chunk andChunks(const Chunk &a, const Chunk &b);
+    static Chunk orChunks(const Chunk &a, const Chunk &b);
+    static uint32_t andChunkCount(const Chunk &a, const Chunk &b);
+
+    std::vector<Chunk> chunks_;             // sorted by key, none empty
+};
@@ -0,0 +1,154 @@
+#include "Catalog.h"
+#include "IdInterner.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Whole amounts are written as integers, as Supabase returns them
+    Json::Value numberJson(double value) {
+        if(value == std::floor(value) && std::fabs(value) < 1e15) {
+            return Json::Value(static_cast<Json::Int64>(value));
+        }
+        return Json::Value(value);
+    }
+}
+
+void Catalog::index() {
+    uint32_t keys = 0;
+    for(const auto &landlord : landlords) keys = std::max(keys, landlord.key + 1);
+    landlordByKey_.assign(keys, IdInterner::NONE);
+    for(uint32_t i = 0; i < landlords.size(); i++) {
+        landlordByKey_[landlords[i].key] = i;
+    }
+    for(auto &landlord : landlords) {
+        landlord.unitCount = 0;
+        for(uint32_t p = landlord.firstProperty; p < landlord.firstProperty + landlord.propertyCount; p++) {
+            landlord.unitCount += properties[p].unitCount;
+        }
+    }
+
+    std::vector<std::string> names;
+    names.reserve(landlords.size());
+    for(const auto &landlord : landlords) names.push_back(landlord.name);
+    nameIndex_.build(names);
+
+    std::vector<std::string> addresses;
+    addresses.reserve(properties.size());
+    for(const auto &property : properties) addresses.push_back(addressText(property));
+    addressIndex_.build(addresses);
+
+    unitStore_.build(*this);
+    facetIndex_.build(unitStore_);
+}
+
+size_t Catalog::memoryBytes() const {
+    size_t bytes = landlords.capacity() * sizeof(Landlord) + properties.capacity() * sizeof(Property)
+                 + units.capacity() * sizeof(Unit);
+    for(const auto &landlord : landlords) {
+        bytes += landlord.landlordId.size() + landlord.name.size() + landlord.email.size() + landlord.phone.size();
+    }
+    for(const auto &property : properties) {
+        bytes += property.propertyId.size() + property.street.size() + property.city.size()
+               + property.province.size() + property.zip.size();
+    }
+    for(const auto &unit : units) bytes += unit.unitNumber.size();
+    return bytes;
+}
+
+size_t Catalog::jsonBytes() const {
+    std::call_once(jsonMeasured_, [this]() {
+        Json::Value all(Json::arrayValue);
+        for(const auto &landlord : landlords) all.append(toJson(landlord));
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        jsonBytes_ = Json::writeString(writer, all).size();
+    });
+    return jsonBytes_;
+}
+
+std::vector<uint32_t> Catalog::searchNames(const std::string &query) const {
+    return nameIndex_.find(query);
+}
+
+std::vector<uint32_t> Catalog::searchAddresses(const std::string &query) const {
+    return addressIndex_.find(query);
+}
+
+std::string Catalog::addressText(const Property &property) {
+    return property.street + ", " + property.city + ", " + property.province + " " + property.zip;
+}
+
+void Catalog::indexFuzzy() const {
+    std::call_once(fuzzyIndexed_, [this]() {
+        std::vector<std::string> names;
+        names.reserve(landlords.size());
+        for(const auto &landlord : landlords) names.push_back(landlord.name);
+        fuzzyIndex_.build(names);
+    });
+}
+
+std::vector<FuzzyIndex::Match> Catalog::searchNamesFuzzy(const std::string &query, int maxDistance) const {
+    indexFuzzy();
+    return fuzzyIndex_.find(query, maxDistance);
+}
+
+const Landlord *Catalog::findLandlord(const std::string &landlordId) const {
+    return findLandlord(IdInterner::landlords().find(landlordId));
+}
+
+const Landlord *Catalog::findLandlord(uint32_t key) const {
+    if(key >= landlordByKey_.size() || landlordByKey_[key] == IdInterner::NONE) return nullptr;
+    return &landlords[landlordByKey_[key]];
+}
+
+Json::Value Catalog::toJson(const Landlord &landlord) const {
+    Json::Value ll(Json::objectValue);
+    ll["landlord_id"] = landlord.landlordId;
+    ll["name"] = landlord.name;
+
+    Json::Value contact(Json::objectValue);
+    contact["email"] = landlord.email;
+    contact["phone"] = landlord.phone;
+    ll["contact"] = contact;
+
+    Json::Value props(Json::arrayValue);
+    for(uint32_t p = landlord.firstProperty; p < landlord.firstProperty + landlord.propertyCount; p++) {
+        props.append(toJson(properties[p]));
+    }
+    ll["properties"] = props;
+    return ll;
+}
+
+Json::Value Catalog::toJson(const Property &property) const {
+    Json::Value prop(Json::objectValue);
+    prop["property_id"] = property.propertyId;
+
+    Json::Value address(Json::objectValue);
+    address["street"] = property.street;
+    address["city"] = property.city;
+    address["province"] = property.province;
+    address["zip"] = property.zip;
+    prop["address"] = address;
+
+    Json::Value unitDetails(Json::arrayValue);
+    for(uint32_t u = property.firstUnit; u < property.firstUnit + property.unitCount; u++) {
+        unitDetails.append(toJson(units[u]));
+    }
+    prop["unit_details"] = unitDetails;
+    return prop;
+}
+
+Json::Value Catalog::toJson(const Unit &unit) {
+    Json::Value unitJson(Json::objectValue);
+    unitJson["unit_number"] = unit.unitNumber;
+    unitJson["bedrooms"] = unit.bedrooms;
+    unitJson["bathrooms"] = numberJson(unit.bathrooms);
+    unitJson["rent"] = numberJson(unit.rent);
+    return unitJson;
+}
+
+void ReviewSet::add(const std::string &reviewId, const std::string &landlordId, int rating) {
+    reviewIds.push_back(reviewId);
+    landlordKeys.push_back(IdInterner::landlords().intern(landlordId));
+    ratings.push_back(rating >= 1 && rating <= 5 ? static_cast<uint8_t>(rating) : 0);
+}
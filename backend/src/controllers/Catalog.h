@@ -0,0 +1,130 @@
+#pragma once
+#include "FacetIndex.h"
+#include "FuzzyIndex.h"
+#include "NameIndex.h"
+#include "UnitStore.h"
+#include <json/json.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+    What is the Catalog?
+    The landlord catalog held as plain structs instead of Json::Value trees. Landlords,
+    properties and units each live in one contiguous vector: the properties of a landlord
+    are a consecutive run of Catalog::properties, and the units of a property a consecutive
+    run of Catalog::units, so a landlord's whole record is reached with index arithmetic.
+
+    SupabaseHelper fills a Catalog when it loads the data and the cached copy is shared
+    read-only by every request. JSON is only produced at the response boundary (toJson).
+*/
+
+struct Unit {
+    std::string unitNumber;
+    int bedrooms = 0;
+    double bathrooms = 0;
+    double rent = 0;
+};
+
+struct Property {
+    std::string propertyId;
+    uint32_t key = 0;           // propertyId interned by IdInterner::properties()
+    std::string street;
+    std::string city;
+    std::string province;
+    std::string zip;
+    uint32_t firstUnit = 0;     // units are Catalog::units[firstUnit, firstUnit + unitCount)
+    uint32_t unitCount = 0;
+};
+
+struct Landlord {
+    std::string landlordId;
+    uint32_t key = 0;           // landlordId interned by IdInterner::landlords()
+    std::string name;
+    std::string email;
+    std::string phone;
+    uint32_t firstProperty = 0; // properties are Catalog::properties[firstProperty, firstProperty + propertyCount)
+    uint32_t propertyCount = 0;
+    uint32_t unitCount = 0;     // units over all its properties, filled in by Catalog::index()
+};
+
+class Catalog {
+public:
+    std::vector<Landlord> landlords;
+    std::vector<Property> properties;
+    std::vector<Unit> units;
+
+    // Build the landlord key lookup, the name and address indexes, the unit columns and the
+    // facet index and count each landlord's units; call once all landlords have been added
+    void index();
+
+    // Build the fuzzy name index now instead of on the first fuzzy search; call after index()
+    void indexFuzzy() const;
+
+    // Landlord with this ID or interned key, or nullptr
+    const Landlord *findLandlord(const std::string &landlordId) const;
+    const Landlord *findLandlord(uint32_t key) const;
+
+    // The landlord in the API's response shape:
+    // {landlord_id, name, contact{email, phone}, properties[{property_id, address{...}, unit_details[...]}]}
+    Json::Value toJson(const Landlord &landlord) const;
+    // {property_id, address{...}, unit_details[...]} and one unit_details entry
+    Json::Value toJson(const Property &property) const;
+    static Json::Value toJson(const Unit &unit);
+
+    // "street, city, province zip", the text an address search looks in
+    static std::string addressText(const Property &property);
+
+    // Positions in landlords of those whose name contains query, ignoring case, in catalog order
+    std::vector<uint32_t> searchNames(const std::string &query) const;
+
+    // Positions in properties of those whose address (street, city, province and zip)
+    // contains query, ignoring case, in catalog order
+    std::vector<uint32_t> searchAddresses(const std::string &query) const;
+
+    // Landlords with a name, or a word of it, within maxDistance edits of query, in catalog order.
+    // The first call builds the fuzzy index unless indexFuzzy() already has
+    std::vector<FuzzyIndex::Match> searchNamesFuzzy(const std::string &query, int maxDistance) const;
+
+    // The units in dictionary encoded columns, with sorted rent and bedroom columns
+    const UnitStore &unitStore() const { return unitStore_; }
+
+    // Bitmap indexes of the units by city, province, bedrooms and rent
+    const FacetIndex &facets() const { return facetIndex_; }
+
+    // Approximate bytes held by the landlord, property and unit structs and their strings
+    size_t memoryBytes() const;
+
+    // Bytes of every landlord written as one compact JSON array (toJson), i.e. what the
+    // catalog took as JSON; serialized on the first call and remembered for the snapshot
+    size_t jsonBytes() const;
+
+private:
+    std::vector<uint32_t> landlordByKey_;   // position in landlords by landlord key, or IdInterner::NONE
+    NameIndex nameIndex_;
+    NameIndex addressIndex_;                // over the properties' addresses (see addressText)
+    // Built lazily: the BK-tree is the slowest index to build and only fuzzy search uses it
+    mutable FuzzyIndex fuzzyIndex_;
+    mutable std::once_flag fuzzyIndexed_;
+    mutable size_t jsonBytes_ = 0;
+    mutable std::once_flag jsonMeasured_;
+    UnitStore unitStore_;
+    FacetIndex facetIndex_;
+};
+
+/*
+    Ratings of every review, stored column-wise: review i is reviewIds[i], landlordKeys[i]
+    and ratings[i]. Landlords are referred to by their interned key (IdInterner::landlords()),
+    and the two numeric columns are what countRatings scans.
+*/
+class ReviewSet {
+public:
+    std::vector<std::string> reviewIds;
+    std::vector<uint32_t> landlordKeys;
+    std::vector<uint8_t> ratings;           // 0 marks a rating outside 1-5
+
+    size_t size() const { return ratings.size(); }
+
+    void add(const std::string &reviewId, const std::string &landlordId, int rating);
+};
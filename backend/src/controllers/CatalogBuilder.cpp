@@ -0,0 +1,78 @@
+#include "CatalogBuilder.h"
+#include <algorithm>
+
+namespace {
+    // Rows of a table grouped by an interned key, in compressed sparse row form: the rows
+    // with key k are rows[first[k], first[k + 1]), in their original order
+    struct RowsByKey {
+        std::vector<uint32_t> first;
+        std::vector<uint32_t> rows;
+
+        explicit RowsByKey(const std::vector<uint32_t> &keys) {
+            uint32_t keyCount = 0;
+            for(uint32_t key : keys) keyCount = std::max(keyCount, key + 1);
+            first.assign(keyCount + 1, 0);
+            rows.resize(keys.size());
+            for(uint32_t key : keys) first[key + 1]++;
+            for(uint32_t k = 0; k < keyCount; k++) first[k + 1] += first[k];
+            std::vector<uint32_t> next(first.begin(), first.end() - 1);
+            for(uint32_t i = 0; i < keys.size(); i++) rows[next[keys[i]]++] = i;
+        }
+
+        uint32_t begin(uint32_t key) const { return key + 1 < first.size() ? first[key] : 0; }
+        uint32_t end(uint32_t key) const { return key + 1 < first.size() ? first[key + 1] : 0; }
+    };
+}
+
+void CatalogBuilder::reserve(size_t landlords, size_t properties, size_t units) {
+    landlords_.reserve(landlords);
+    properties_.reserve(properties);
+    propertyLandlords_.reserve(properties);
+    units_.reserve(units);
+    unitProperties_.reserve(units);
+}
+
+void CatalogBuilder::addLandlord(Landlord &&landlord) {
+    landlords_.push_back(std::move(landlord));
+}
+
+void CatalogBuilder::addProperty(uint32_t landlordKey, Property &&property) {
+    properties_.push_back(std::move(property));
+    propertyLandlords_.push_back(landlordKey);
+}
+
+void CatalogBuilder::addUnit(uint32_t propertyKey, Unit &&unit) {
+    units_.push_back(std::move(unit));
+    unitProperties_.push_back(propertyKey);
+}
+
+std::shared_ptr<Catalog> CatalogBuilder::join() {
+    RowsByKey propertiesByLandlord(propertyLandlords_);
+    RowsByKey unitsByProperty(unitProperties_);
+
+    auto catalog = std::make_shared<Catalog>();
+    catalog->landlords.reserve(landlords_.size());
+    catalog->properties.reserve(properties_.size());
+    catalog->units.reserve(units_.size());
+
+    // IDs are primary keys, so every property and unit row is moved out at most once
+    for(auto &landlord : landlords_) {
+        landlord.firstProperty = static_cast<uint32_t>(catalog->properties.size());
+        landlord.propertyCount = 0;
+        for(uint32_t p = propertiesByLandlord.begin(landlord.key); p < propertiesByLandlord.end(landlord.key); p++) {
+            Property &property = properties_[propertiesByLandlord.rows[p]];
+            property.firstUnit = static_cast<uint32_t>(catalog->units.size());
+            property.unitCount = 0;
+            for(uint32_t u = unitsByProperty.begin(property.key); u < unitsByProperty.end(property.key); u++) {
+                catalog->units.push_back(std::move(units_[unitsByProperty.rows[u]]));
+                property.unitCount++;
+            }
+            catalog->properties.push_back(std::move(property));
+            landlord.propertyCount++;
+        }
+        catalog->landlords.push_back(std::move(landlord));
+    }
+
+    *this = CatalogBuilder();
+    return catalog;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Catalog.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+    What is the CatalogBuilder?
+    Collects the rows of the landlords, properties and units tables as they are read, each
+    property carrying its landlord's interned key and each unit its property's, and joins
+    them into a Catalog. Properties are grouped by landlord key and units by property key
+    in compressed sparse row form first, so the join is linear in the number of rows and
+    works on flat arrays. Rows keep the order in which Supabase returned them; rows whose
+    parent is missing are dropped.
+*/
+class CatalogBuilder {
+public:
+    void reserve(size_t landlords, size_t properties, size_t units);
+
+    // key fields must already be interned
+    void addLandlord(Landlord &&landlord);
+    void addProperty(uint32_t landlordKey, Property &&property);
+    void addUnit(uint32_t propertyKey, Unit &&unit);
+
+    // Move the rows into a catalog. Does not index it (see Catalog::index)
+    std::shared_ptr<Catalog> join();
+
+private:
+    std::vector<Landlord> landlords_;
+    std::vector<Property> properties_;
+    std::vector<uint32_t> propertyLandlords_;   // landlord key of properties_[i]
+    std::vector<Unit> units_;
+    std::vector<uint32_t> unitProperties_;      // property key of units_[i]
+};
@@ -0,0 +1,177 @@
+#include "CatalogReader.h"
+#include "IdInterner.h"
+#include <cstdlib>
+#include <utility>
+
+std::string RowReader::Scalar::takeText() const {
+    return kind == Kind::Null ? std::string() : std::move(text);
+}
+
+double RowReader::Scalar::number() const {
+    if(kind == Kind::Number || kind == Kind::Text) return std::strtod(text.c_str(), nullptr);
+    return 0;
+}
+
+bool RowReader::childRows(int, const std::string &) const {
+    return false;
+}
+
+void RowReader::startObject() {
+    Frame frame{true, SKIPPED};
+    if(!stack_.empty() && !stack_.back().isObject && stack_.back().level != SKIPPED) {
+        frame.level = stack_.back().level;
+        startRow(frame.level);
+    }
+    stack_.push_back(frame);
+}
+
+void RowReader::endObject() {
+    Frame frame = stack_.back();
+    stack_.pop_back();
+    if(frame.level != SKIPPED) endRow(frame.level);
+}
+
+void RowReader::startArray() {
+    Frame frame{false, SKIPPED};
+    if(stack_.empty()) {
+        valid_ = true;
+        frame.level = 0;
+    } else if(stack_.back().isObject && stack_.back().level != SKIPPED && childRows(stack_.back().level, column_)) {
+        frame.level = stack_.back().level + 1;
+    }
+    stack_.push_back(frame);
+}
+
+void RowReader::endArray() {
+    stack_.pop_back();
+}
+
+void RowReader::key(std::string &&name) {
+    column_ = std::move(name);
+}
+
+void RowReader::stringValue(std::string &&value) {
+    scalar(Kind::Text, value);
+}
+
+void RowReader::numberValue(const std::string &text) {
+    literal_ = text;
+    scalar(Kind::Number, literal_);
+}
+
+void RowReader::boolValue(bool value) {
+    literal_ = value ? "true" : "false";
+    scalar(Kind::Bool, literal_);
+}
+
+void RowReader::nullValue() {
+    literal_.clear();
+    scalar(Kind::Null, literal_);
+}
+
+void RowReader::scalar(Kind kind, std::string &text) {
+    if(stack_.empty() || !stack_.back().isObject || stack_.back().level == SKIPPED) return;
+    column(stack_.back().level, column_, Scalar{kind, text});
+}
+
+CatalogReader::Table CatalogReader::rowTable(int level) const {
+    if(table_ != Table::Embedded) return table_;
+    if(level == 0) return Table::Landlords;
+    return level == 1 ? Table::Properties : Table::Units;
+}
+
+bool CatalogReader::childRows(int level, const std::string &column) const {
+    if(table_ != Table::Embedded) return false;
+    return (level == 0 && column == "properties") || (level == 1 && column == "units");
+}
+
+void CatalogReader::startRow(int level) {
+    switch(rowTable(level)) {
+    case Table::Landlords: landlord_ = Landlord(); break;
+    case Table::Properties: property_ = Property(); break;
+    case Table::Units: unit_ = Unit(); break;
+    case Table::Embedded: break;
+    }
+    parentId_.clear();
+}
+
+void CatalogReader::column(int level, const std::string &name, const Scalar &value) {
+    switch(rowTable(level)) {
+    case Table::Landlords:
+        if(name == "landlord_id") landlord_.landlordId = value.takeText();
+        else if(name == "name") landlord_.name = value.takeText();
+        else if(name == "contact_email") landlord_.email = value.takeText();
+        else if(name == "contact_phone") landlord_.phone = value.takeText();
+        break;
+    case Table::Properties:
+        if(name == "property_id") property_.propertyId = value.takeText();
+        else if(name == "street") property_.street = value.takeText();
+        else if(name == "city") property_.city = value.takeText();
+        else if(name == "province") property_.province = value.takeText();
+        else if(name == "zip") property_.zip = value.takeText();
+        else if(name == "landlord_id") parentId_ = value.takeText();
+        break;
+    case Table::Units:
+        if(name == "unit_number") unit_.unitNumber = value.takeText();
+        else if(name == "bedrooms") unit_.bedrooms = static_cast<int>(value.number());
+        else if(name == "bathrooms") unit_.bathrooms = value.number();
+        else if(name == "rent") unit_.rent = value.number();
+        else if(name == "property_id") parentId_ = value.takeText();
+        break;
+    case Table::Embedded:
+        break;
+    }
+}
+
+void CatalogReader::endRow(int level) {
+    switch(rowTable(level)) {
+    case Table::Landlords:
+        landlord_.key = IdInterner::landlords().intern(landlord_.landlordId);
+        for(size_t i = 0; i < units_.size(); i++) {
+            builder_.addUnit(properties_[unitOwners_[i]].key, std::move(units_[i]));
+        }
+        for(auto &property : properties_) {
+            builder_.addProperty(landlord_.key, std::move(property));
+        }
+        units_.clear();
+        unitOwners_.clear();
+        properties_.clear();
+        builder_.addLandlord(std::move(landlord_));
+        break;
+    case Table::Properties:
+        property_.key = IdInterner::properties().intern(property_.propertyId);
+        if(table_ == Table::Embedded) {
+            properties_.push_back(std::move(property_));
+        } else {
+            builder_.addProperty(IdInterner::landlords().intern(parentId_), std::move(property_));
+        }
+        break;
+    case Table::Units:
+        if(table_ == Table::Embedded) {
+            // The property that holds this unit is the next one to end
+            unitOwners_.push_back(static_cast<uint32_t>(properties_.size()));
+            units_.push_back(std::move(unit_));
+        } else {
+            builder_.addUnit(IdInterner::properties().intern(parentId_), std::move(unit_));
+        }
+        break;
+    case Table::Embedded:
+        break;
+    }
+}
+
+void ReviewReader::startRow(int) {
+    reviewId_.clear();
+    landlordId_.clear();
+    rating_ = 0;
+}
+
+void ReviewReader::column(int, const std::string &name, const Scalar &value) {
+    if(name == "id") reviewId_ = value.takeText();
+    else if(name == "landlord_id") landlordId_ = value.takeText();
+    else if(name == "rating") rating_ = static_cast<int>(value.number());
+}
+
+void ReviewReader::endRow(int) {
+    reviews_.add(reviewId_, landlordId_, rating_);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "Catalog.h"
+#include "CatalogBuilder.h"
+#include "JsonStream.h"
+#include <string>
+#include <vector>
+
+/*
+    What are the row readers?
+    JsonSaxHandlers that read a PostgREST response (a JSON array of row objects) straight
+    into the catalog structs while JsonStreamParser walks it, so the catalog, units and
+    reviews fetches never build a Json::Value for the whole body. Only the columns the
+    catalog keeps are copied out of a row; any other value, however deeply nested, is
+    skipped as it streams past.
+
+    Columns read like the old Json::Value readers did: null or missing text is "", and a
+    number may arrive either as a JSON number or as a numeric string.
+*/
+
+// Walks the rows of a response and hands every scalar column to the subclass. Rows can
+// nest: a column whose value is an array of objects holds child rows one level down
+class RowReader : public JsonSaxHandler {
+public:
+    // True once the document turned out to be an array (of rows)
+    bool valid() const { return valid_; }
+
+    void startObject() override;
+    void endObject() override;
+    void startArray() override;
+    void endArray() override;
+    void key(std::string &&name) override;
+    void stringValue(std::string &&value) override;
+    void numberValue(const std::string &text) override;
+    void boolValue(bool value) override;
+    void nullValue() override;
+
+protected:
+    enum class Kind { Text, Number, Bool, Null };
+
+    // A column value as it was read; numbers and booleans keep their JSON spelling
+    struct Scalar {
+        Kind kind;
+        std::string &text;
+
+        std::string takeText() const;
+        double number() const;
+    };
+
+    // Rows of level 0 are the elements of the top-level array
+    virtual bool childRows(int level, const std::string &column) const;
+    virtual void startRow(int level) = 0;
+    virtual void column(int level, const std::string &name, const Scalar &value) = 0;
+    virtual void endRow(int level) = 0;
+
+private:
+    static const int SKIPPED = -1;
+
+    // One open container. level is the row level of an object, or the level of the rows an
+    // array holds; SKIPPED for values the reader does not look into
+    struct Frame {
+        bool isObject;
+        int level;
+    };
+
+    void scalar(Kind kind, std::string &text);
+
+    std::vector<Frame> stack_;
+    std::string column_;
+    std::string literal_;
+    bool valid_ = false;
+};
+
+// Reads the landlords catalog into a CatalogBuilder, either from one table scan or from the
+// embedded select, where each landlord nests its properties and each property its units
+class CatalogReader : public RowReader {
+public:
+    enum class Table { Embedded, Landlords, Properties, Units };
+
+    CatalogReader(CatalogBuilder &builder, Table table) : builder_(builder), table_(table) {}
+
+protected:
+    bool childRows(int level, const std::string &column) const override;
+    void startRow(int level) override;
+    void column(int level, const std::string &name, const Scalar &value) override;
+    void endRow(int level) override;
+
+private:
+    // Which struct rows of a level fill
+    Table rowTable(int level) const;
+
+    CatalogBuilder &builder_;
+    Table table_;
+
+    Landlord landlord_;
+    Property property_;
+    Unit unit_;
+    std::string parentId_;                  // landlord_id of a property row, property_id of a unit row
+
+    // Embedded rows are held until their parent row ends, so the parent's key does not
+    // depend on where its id column sits relative to the nested arrays
+    std::vector<Property> properties_;
+    std::vector<Unit> units_;
+    std::vector<uint32_t> unitOwners_;      // index into properties_ of units_[i]
+};
+
+// Reads the id, landlord_id and rating columns of the reviews table into a ReviewSet
+class ReviewReader : public RowReader {
+public:
+    explicit ReviewReader(ReviewSet &reviews) : reviews_(reviews) {}
+
+protected:
+    void startRow(int level) override;
+    void column(int level, const std::string &name, const Scalar &value) override;
+    void endRow(int level) override;
+
+private:
+    ReviewSet &reviews_;
+    std::string reviewId_;
+    std::string landlordId_;
+    int rating_ = 0;
+};
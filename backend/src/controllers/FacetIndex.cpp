@@ -0,0 +1,136 @@
+#include "FacetIndex.h"
+#include "UnitStore.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Cents in dollars * 100 within this of a whole cent count as that cent: 4.35 * 100 is
+    // 434.99999999999994 and 1.1 * 100 is 110.00000000000001, and rounding either inward as
+    // it stands would leave out a unit at exactly that rent
+    const double CENT_TOLERANCE = 1e-6;
+
+    uint32_t clampCents(double cents) {
+        return static_cast<uint32_t>(std::min(std::max(cents, 0.0), 4294967295.0));
+    }
+
+    // Whole cents for a bound in dollars, rounded inward (up for the minimum, down for the
+    // maximum) and clamped to what the rent column can hold
+    uint32_t minCents(double dollars) {
+        return clampCents(std::ceil(dollars * 100 - CENT_TOLERANCE));
+    }
+
+    uint32_t maxCents(double dollars) {
+        return clampCents(std::floor(dollars * 100 + CENT_TOLERANCE));
+    }
+
+    uint16_t toBedrooms(int value) {
+        return static_cast<uint16_t>(std::min(std::max(value, 0), 65535));
+    }
+}
+
+void FacetIndex::build(const UnitStore &store) {
+    *this = FacetIndex();
+    cities_.resize(store.cities().size());
+    provinces_.resize(store.provinces().size());
+
+    // Units are visited in position order, so every bitmap receives increasing values
+    for(uint32_t u = 0; u < store.size(); u++) {
+        all_.append(u);
+        cities_[store.cityId[u]].append(u);
+        provinces_[store.provinceId[u]].append(u);
+        bedrooms_[store.bedrooms[u]].append(u);
+        rentBuckets_[store.rentCents[u] / 100 / RENT_BUCKET].append(u);
+    }
+}
+
+Bitmap FacetIndex::match(const UnitStore &store, const FacetQuery &query) const {
+    Bitmap result = all_;
+
+    if(!query.city.empty()) {
+        uint32_t city = store.findCity(query.city);
+        if(city == UnitStore::NONE) return Bitmap();
+        result = result & cities_[city];
+    }
+    if(!query.province.empty()) {
+        uint32_t province = store.findProvince(query.province);
+        if(province == UnitStore::NONE) return Bitmap();
+        result = result & provinces_[province];
+    }
+
+    if(query.minBedrooms || query.maxBedrooms) {
+        if(query.maxBedrooms && *query.maxBedrooms < 0) return Bitmap();
+        uint16_t low = toBedrooms(query.minBedrooms.value_or(0));
+        uint16_t high = toBedrooms(query.maxBedrooms.value_or(std::numeric_limits<int>::max()));
+        Bitmap units;
+        for(auto it = bedrooms_.lower_bound(low); it != bedrooms_.end() && it->first <= high; ++it) {
+            units = units | it->second;
+        }
+        result = result & units;
+    }
+
+    if(query.minRent || query.maxRent) {
+        if(query.maxRent && *query.maxRent < 0) return Bitmap();
+        uint32_t low = query.minRent ? minCents(*query.minRent) : 0;
+        uint32_t high = query.maxRent ? maxCents(*query.maxRent) : std::numeric_limits<uint32_t>::max();
+        result = result & rentRange(store, low, high);
+    }
+    return result;
+}
+
+Bitmap FacetIndex::rentRange(const UnitStore &store, uint32_t minCents, uint32_t maxCents) const {
+    Bitmap units;
+    if(minCents > maxCents) return units;
+    const uint64_t bucketCents = uint64_t(RENT_BUCKET) * 100;
+    auto end = rentBuckets_.upper_bound(static_cast<uint32_t>(maxCents / bucketCents));
+    for(auto it = rentBuckets_.lower_bound(static_cast<uint32_t>(minCents / bucketCents)); it != end; ++it) {
+        uint64_t first = it->first * bucketCents;
+        uint64_t last = first + bucketCents - 1;
+        if(first >= minCents && last <= maxCents) {
+            units = units | it->second;
+            continue;
+        }
+        // A bucket the range cuts through: keep its units whose rent is in range
+        Bitmap inRange;
+        for(uint32_t u : it->second.values()) {
+            if(store.rentCents[u] >= minCents && store.rentCents[u] <= maxCents) inRange.append(u);
+        }
+        units = units | inRange;
+    }
+    return units;
+}
+
+Json::Value FacetIndex::counts(const UnitStore &store, const Bitmap &units) const {
+    Json::Value facets(Json::objectValue);
+
+    Json::Value cities(Json::objectValue);
+    for(uint32_t c = 0; c < cities_.size(); c++) {
+        uint32_t count = cities_[c].andCardinality(units);
+        if(count > 0) cities[store.cities()[c]] = count;
+    }
+    facets["city"] = cities;
+
+    Json::Value provinces(Json::objectValue);
+    for(uint32_t p = 0; p < provinces_.size(); p++) {
+        uint32_t count = provinces_[p].andCardinality(units);
+        if(count > 0) provinces[store.provinces()[p]] = count;
+    }
+    facets["province"] = provinces;
+
+    Json::Value bedrooms(Json::objectValue);
+    for(const auto &entry : bedrooms_) {
+        uint32_t count = entry.second.andCardinality(units);
+        if(count > 0) bedrooms[std::to_string(entry.first)] = count;
+    }
+    facets["bedrooms"] = bedrooms;
+
+    Json::Value rent(Json::objectValue);
+    for(const auto &entry : rentBuckets_) {
+        uint32_t count = entry.second.andCardinality(units);
+        if(count == 0) continue;
+        uint64_t low = static_cast<uint64_t>(entry.first) * RENT_BUCKET;
+        rent[std::to_string(low) + "-" + std::to_string(low + RENT_BUCKET - 1)] = count;
+    }
+    facets["rent"] = rent;
+    return facets;
+}
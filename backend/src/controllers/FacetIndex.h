@@ -0,0 +1,53 @@
+#pragma once
+#include "Bitmap.h"
+#include <json/json.h>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+class UnitStore;
+
+// Filters of a property search; unset fields match everything
+struct FacetQuery {
+    std::string city;       // compared ignoring case
+    std::string province;
+    std::optional<int> minBedrooms;
+    std::optional<int> maxBedrooms;
+    std::optional<double> minRent;
+    std::optional<double> maxRent;
+};
+
+/*
+    What is the FacetIndex?
+    Bitmap indexes over the units of one catalog snapshot, built with the catalog from its
+    UnitStore: one bitmap of unit positions per city, per province and per bedroom count,
+    and one per rent bucket of RENT_BUCKET dollars. A search ANDs the city and province
+    bitmaps with the bedroom and rent ranges, each the OR of the bitmaps in range, and the
+    facet counts of the result are intersection sizes.
+*/
+class FacetIndex {
+public:
+    static constexpr uint32_t RENT_BUCKET = 250;
+
+    void build(const UnitStore &store);
+
+    // Positions in Catalog::units of the units matching every filter
+    Bitmap match(const UnitStore &store, const FacetQuery &query) const;
+
+    // Units per city, province, bedroom count and rent bucket among units, e.g.
+    // {"city": {"Kingston": 12}, "bedrooms": {"2": 7}, "rent": {"1500-1749": 3}, ...}
+    Json::Value counts(const UnitStore &store, const Bitmap &units) const;
+
+private:
+    // Units with minCents <= rent <= maxCents: the rent buckets inside the range as they
+    // are, and the units of the (at most two) buckets it cuts through checked one by one
+    Bitmap rentRange(const UnitStore &store, uint32_t minCents, uint32_t maxCents) const;
+
+    Bitmap all_;
+    std::vector<Bitmap> cities_;            // by city id
+    std::vector<Bitmap> provinces_;         // by province id
+    std::map<uint16_t, Bitmap> bedrooms_;
+    std::map<uint32_t, Bitmap> rentBuckets_;    // by whole dollars / RENT_BUCKET
+};
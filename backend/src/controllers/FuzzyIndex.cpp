@@ -0,0 +1,134 @@
+#include "FuzzyIndex.h"
+#include "NameIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <utility>
+
+namespace {
+    // Damerau-Levenshtein distance over bytes: insertions, deletions, substitutions and
+    // transpositions of adjacent bytes each cost one, so "smtih" is one edit from "smith".
+    // This is the unrestricted distance (Lowrance-Wagner), which allows further edits
+    // between transposed bytes; the restricted "optimal string alignment" variant breaks
+    // the triangle inequality that the BK-tree relies on. table is scratch space
+    int editDistance(const std::string &a, const std::string &b, std::vector<int> &table) {
+        // table is (a.size() + 2) x (b.size() + 2); row and column 0 hold a sentinel larger
+        // than any distance, and cell (i + 1, j + 1) is the distance of the prefixes a[0, i), b[0, j)
+        const size_t columns = b.size() + 2;
+        const int infinity = static_cast<int>(a.size() + b.size());
+        table.assign((a.size() + 2) * columns, infinity);
+        auto cell = [&](size_t i, size_t j) -> int & { return table[i * columns + j]; };
+        for(size_t i = 0; i <= a.size(); i++) cell(i + 1, 1) = static_cast<int>(i);
+        for(size_t j = 0; j <= b.size(); j++) cell(1, j + 1) = static_cast<int>(j);
+
+        // Last row of a in which each byte occurred so far
+        size_t lastRow[256] = {};
+        for(size_t i = 1; i <= a.size(); i++) {
+            size_t lastMatchColumn = 0;
+            for(size_t j = 1; j <= b.size(); j++) {
+                size_t k = lastRow[static_cast<unsigned char>(b[j - 1])];
+                size_t l = lastMatchColumn;
+                int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+                if(cost == 0) lastMatchColumn = j;
+                cell(i + 1, j + 1) = std::min({cell(i, j) + cost,
+                                               cell(i + 1, j) + 1,
+                                               cell(i, j + 1) + 1,
+                                               cell(k, l) + static_cast<int>((i - k - 1) + 1 + (j - l - 1))});
+            }
+            lastRow[static_cast<unsigned char>(a[i - 1])] = i;
+        }
+        return cell(a.size() + 1, b.size() + 1);
+    }
+}
+
+void FuzzyIndex::build(const std::vector<std::string> &names) {
+    // Distinct terms with the names that contain them
+    std::vector<std::pair<std::string, uint32_t>> pairs;
+    for(uint32_t i = 0; i < names.size(); i++) {
+        std::string folded = NameIndex::fold(names[i]);
+        if(folded.empty()) continue;
+        pairs.push_back({folded, i});
+        size_t j = 0;
+        while(j < folded.size()) {
+            while(j < folded.size() && !std::isalnum(static_cast<unsigned char>(folded[j]))) j++;
+            size_t start = j;
+            while(j < folded.size() && std::isalnum(static_cast<unsigned char>(folded[j]))) j++;
+            if(j > start) pairs.push_back({folded.substr(start, j - start), i});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    terms_.clear();
+    first_.clear();
+    postings_.clear();
+    for(auto &pair : pairs) {
+        if(terms_.empty() || terms_.back() != pair.first) {
+            terms_.push_back(std::move(pair.first));
+            first_.push_back(static_cast<uint32_t>(postings_.size()));
+        }
+        postings_.push_back(pair.second);
+    }
+    first_.push_back(static_cast<uint32_t>(postings_.size()));
+
+    // Insert every term into a pointer-based tree, then lay it out breadth first so each
+    // node's children sit in one contiguous run
+    std::vector<std::map<int, uint32_t>> links(terms_.size());
+    std::vector<int> table;
+    for(uint32_t t = 1; t < terms_.size(); t++) {
+        uint32_t node = 0;
+        for(;;) {
+            int distance = editDistance(terms_[t], terms_[node], table);
+            auto inserted = links[node].emplace(distance, t);
+            if(inserted.second) break;
+            node = inserted.first->second;
+        }
+    }
+
+    nodes_.clear();
+    children_.clear();
+    if(terms_.empty()) return;
+    nodes_.reserve(terms_.size());
+    nodes_.push_back(Node{0});
+    for(size_t n = 0; n < nodes_.size(); n++) {
+        nodes_[n].firstChild = static_cast<uint32_t>(children_.size());
+        nodes_[n].childCount = static_cast<uint32_t>(links[nodes_[n].term].size());
+        for(const auto &link : links[nodes_[n].term]) {
+            children_.push_back({link.first, static_cast<uint32_t>(nodes_.size())});
+            nodes_.push_back(Node{link.second});
+        }
+    }
+}
+
+std::vector<FuzzyIndex::Match> FuzzyIndex::find(const std::string &query, int maxDistance) const {
+    std::vector<Match> matches;
+    if(nodes_.empty()) return matches;
+    std::string folded = NameIndex::fold(query);
+
+    // Best distance per name, over every term of it within range
+    std::map<uint32_t, int> best;
+    std::vector<uint32_t> pending{0};
+    std::vector<int> table;
+    while(!pending.empty()) {
+        const Node &node = nodes_[pending.back()];
+        pending.pop_back();
+
+        int distance = editDistance(folded, terms_[node.term], table);
+        if(distance <= maxDistance) {
+            for(uint32_t p = first_[node.term]; p < first_[node.term + 1]; p++) {
+                auto inserted = best.emplace(postings_[p], distance);
+                if(!inserted.second) inserted.first->second = std::min(inserted.first->second, distance);
+            }
+        }
+
+        // Children are sorted by distance, so the ones worth visiting are one contiguous run
+        auto begin = children_.begin() + node.firstChild;
+        auto end = begin + node.childCount;
+        auto it = std::lower_bound(begin, end, distance - maxDistance, [](const Child &c, int d) { return c.distance < d; });
+        for(; it != end && it->distance <= distance + maxDistance; ++it) pending.push_back(it->node);
+    }
+
+    matches.reserve(best.size());
+    for(const auto &entry : best) matches.push_back({entry.first, entry.second});
+    return matches;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+    What is the FuzzyIndex?
+    A BK-tree over the distinct case-folded terms of landlord names: each full name and each
+    word in it. A BK-tree child hangs off its parent by edit distance (Damerau-Levenshtein,
+    so swapping two adjacent letters is one edit), and by the triangle inequality a search
+    within distance k of a query only descends into children whose distance lies within k
+    of the parent's. That answers typo-tolerant lookups ("smtih" for "Smith") without
+    comparing against every name.
+
+    A catalog snapshot builds its index once, on the first call to Catalog::indexFuzzy()
+    (under std::call_once). SupabaseHelper's index thread makes that call right after it
+    publishes the snapshot, so requests normally find the index built.
+*/
+class FuzzyIndex {
+public:
+    struct Match {
+        uint32_t position;  // index of the name as passed to build
+        int distance;       // smallest edit distance between the query and any term of the name
+    };
+
+    // Index names; names[i] is reported as position i
+    void build(const std::vector<std::string> &names);
+
+    // Names with a term within maxDistance edits of query, ignoring case, in position order
+    std::vector<Match> find(const std::string &query, int maxDistance) const;
+
+private:
+    struct Node {
+        uint32_t term;          // index into terms_
+        uint32_t firstChild = 0;
+        uint32_t childCount = 0;
+    };
+
+    struct Child {
+        int distance;           // edit distance from the parent's term
+        uint32_t node;
+    };
+
+    std::vector<std::string> terms_;
+    // Names containing terms_[t] are postings_[first_[t], first_[t + 1])
+    std::vector<uint32_t> first_;
+    std::vector<uint32_t> postings_;
+    // Tree in flat arrays; node 0 is the root and a node's children are contiguous
+    std::vector<Node> nodes_;
+    std::vector<Child> children_;
+};
@@ -0,0 +1,34 @@
+#include "IdInterner.h"
+#include <mutex>
+
+IdInterner &IdInterner::landlords() {
+    static IdInterner interner;
+    return interner;
+}
+
+IdInterner &IdInterner::properties() {
+    static IdInterner interner;
+    return interner;
+}
+
+uint32_t IdInterner::intern(const std::string &id) {
+    {
+        // Almost every ID has been seen before, so try under the shared lock first
+        std::shared_lock<std::shared_mutex> lk(mu_);
+        auto it = keys_.find(id);
+        if(it != keys_.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lk(mu_);
+    return keys_.emplace(id, static_cast<uint32_t>(keys_.size())).first->second;
+}
+
+uint32_t IdInterner::find(const std::string &id) const {
+    std::shared_lock<std::shared_mutex> lk(mu_);
+    auto it = keys_.find(id);
+    return it == keys_.end() ? NONE : it->second;
+}
+
+uint32_t IdInterner::size() const {
+    std::shared_lock<std::shared_mutex> lk(mu_);
+    return static_cast<uint32_t>(keys_.size());
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+    What is the IdInterner?
+    Maps external string IDs ("LL001", "P3_1") to dense uint32_t keys the first time they
+    are seen, so aggregates, indexes and joins can be flat arrays indexed by key instead of
+    maps hashed by string. Keys are never reused or removed while the server runs, and
+    landlord and property IDs each have their own interner.
+*/
+class IdInterner {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    static IdInterner &landlords();
+    static IdInterner &properties();
+
+    // Key of id, assigning the next one if it is new
+    uint32_t intern(const std::string &id);
+
+    // Key of id, or NONE if it was never interned
+    uint32_t find(const std::string &id) const;
+
+    // Number of keys assigned so far; every key is below it
+    uint32_t size() const;
+
+private:
+    IdInterner() = default;
+
+    mutable std::shared_mutex mu_;
+    std::unordered_map<std::string, uint32_t> keys_;
+};
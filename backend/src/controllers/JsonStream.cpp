@@ -0,0 +1,338 @@
+#include "JsonStream.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    bool isNumberChar(char c) {
+        return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+}
+
+bool JsonStreamParser::feed(const char *data, size_t size) {
+    if(!error_.empty()) return false;
+    for(size_t i = 0; i < size; ++i) {
+        char c = data[i];
+
+        // Fast path for the bulk of string contents
+        if(token_ == Token::String && c != '"' && c != '\\') {
+            if(static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+            text_ += c;
+            continue;
+        }
+        if(!step(c)) return false;
+    }
+    return true;
+}
+
+bool JsonStreamParser::finish() {
+    if(!error_.empty()) return false;
+    // A number is only terminated by the character that follows it
+    if(token_ == Token::Number && !finishNumber()) return false;
+    if(token_ != Token::None) return fail("unexpected end of input");
+    if(expect_ != Expect::Done) return fail("unexpected end of input");
+    return true;
+}
+
+bool JsonStreamParser::fail(const std::string &what) {
+    if(error_.empty()) error_ = what;
+    return false;
+}
+
+bool JsonStreamParser::step(char c) {
+    switch(token_) {
+    case Token::String:
+        if(c == '"') return finishString();
+        token_ = Token::StringEscape;
+        return true;
+
+    case Token::StringSurrogate:
+        // A high surrogate must be followed by the \u escape of its low half
+        if(c == '\\') {
+            token_ = Token::StringEscape;
+            return true;
+        }
+        unpairedSurrogate();
+        token_ = Token::String;
+        if(c == '"') return finishString();
+        if(static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+        text_ += c;
+        return true;
+
+    case Token::StringEscape:
+        token_ = Token::String;
+        if(highSurrogate_ && c != 'u') unpairedSurrogate();
+        switch(c) {
+        case '"': text_ += '"'; break;
+        case '\\': text_ += '\\'; break;
+        case '/': text_ += '/'; break;
+        case 'b': text_ += '\b'; break;
+        case 'f': text_ += '\f'; break;
+        case 'n': text_ += '\n'; break;
+        case 'r': text_ += '\r'; break;
+        case 't': text_ += '\t'; break;
+        case 'u': token_ = Token::StringUnicode; unicode_.clear(); break;
+        default: return fail("invalid escape in string");
+        }
+        return true;
+
+    case Token::StringUnicode: {
+        if(!std::isxdigit(static_cast<unsigned char>(c))) return fail("invalid \\u escape in string");
+        unicode_ += c;
+        if(unicode_.size() < 4) return true;
+        token_ = Token::String;
+        unsigned cp = static_cast<unsigned>(std::strtoul(unicode_.c_str(), nullptr, 16));
+        if(cp >= 0xDC00 && cp <= 0xDFFF && highSurrogate_) {
+            appendCodePoint(0x10000 + ((highSurrogate_ - 0xD800) << 10) + (cp - 0xDC00));
+            highSurrogate_ = 0;
+            return true;
+        }
+        if(highSurrogate_) unpairedSurrogate();
+        if(cp >= 0xD800 && cp <= 0xDBFF) {
+            // High surrogate; wait for the low half
+            highSurrogate_ = cp;
+            token_ = Token::StringSurrogate;
+            return true;
+        }
+        // A low surrogate without a high one has no code point either
+        appendCodePoint(cp >= 0xDC00 && cp <= 0xDFFF ? 0xFFFD : cp);
+        return true;
+    }
+
+    case Token::Number:
+        if(isNumberChar(c)) {
+            text_ += c;
+            return true;
+        }
+        if(!finishNumber()) return false;
+        // The terminating character belongs to the grammar, not the number
+        return step(c);
+
+    case Token::Literal: {
+        text_ += c;
+        const char *word = text_[0] == 't' ? "true" : text_[0] == 'f' ? "false" : "null";
+        size_t len = text_[0] == 'f' ? 5 : 4;
+        if(text_.size() > len || text_.back() != word[text_.size() - 1]) return fail("invalid literal");
+        if(text_.size() == len) return finishLiteral();
+        return true;
+    }
+
+    case Token::None:
+        break;
+    }
+
+    if(isSpace(c)) return true;
+
+    switch(expect_) {
+    case Expect::Done:
+        return fail("unexpected data after document");
+
+    case Expect::Colon:
+        if(c != ':') return fail("expected ':'");
+        expect_ = Expect::Value;
+        return true;
+
+    case Expect::CommaOrEnd:
+        if(c == ',') {
+            expect_ = stack_.back() == '{' ? Expect::Key : Expect::Value;
+            return true;
+        }
+        return closeContainer(c);
+
+    case Expect::KeyOrEnd:
+        if(c == '}') return closeContainer(c);
+        // fall through
+    case Expect::Key:
+        if(c != '"') return fail("expected object key");
+        token_ = Token::String;
+        tokenIsKey_ = true;
+        text_.clear();
+        return true;
+
+    case Expect::ValueOrEnd:
+        if(c == ']') return closeContainer(c);
+        // fall through
+    case Expect::Value:
+        break;
+    }
+
+    if(c == '{') {
+        stack_.push_back('{');
+        handler_.startObject();
+        expect_ = Expect::KeyOrEnd;
+        return true;
+    }
+    if(c == '[') {
+        stack_.push_back('[');
+        handler_.startArray();
+        expect_ = Expect::ValueOrEnd;
+        return true;
+    }
+    text_.clear();
+    if(c == '"') {
+        token_ = Token::String;
+        tokenIsKey_ = false;
+        return true;
+    }
+    if(c == '-' || isDigit(c)) {
+        token_ = Token::Number;
+        text_ += c;
+        return true;
+    }
+    if(c == 't' || c == 'f' || c == 'n') {
+        token_ = Token::Literal;
+        text_ += c;
+        return true;
+    }
+    return fail(std::string("unexpected character '") + c + "'");
+}
+
+bool JsonStreamParser::valueDone() {
+    expect_ = stack_.empty() ? Expect::Done : Expect::CommaOrEnd;
+    return true;
+}
+
+bool JsonStreamParser::closeContainer(char c) {
+    char open = c == '}' ? '{' : c == ']' ? '[' : 0;
+    if(!open || stack_.empty() || stack_.back() != open) return fail(std::string("unexpected character '") + c + "'");
+    stack_.pop_back();
+    if(open == '{') handler_.endObject();
+    else handler_.endArray();
+    return valueDone();
+}
+
+bool JsonStreamParser::finishString() {
+    token_ = Token::None;
+    if(tokenIsKey_) {
+        handler_.key(std::move(text_));
+        text_.clear();
+        expect_ = Expect::Colon;
+        return true;
+    }
+    handler_.stringValue(std::move(text_));
+    text_.clear();
+    return valueDone();
+}
+
+bool JsonStreamParser::finishNumber() {
+    token_ = Token::None;
+    // strtod accepts a superset of JSON numbers; reject the obvious malformed cases
+    char *end = nullptr;
+    std::strtod(text_.c_str(), &end);
+    if(text_ == "-" || end != text_.c_str() + text_.size()) return fail("invalid number");
+    handler_.numberValue(text_);
+    return valueDone();
+}
+
+bool JsonStreamParser::finishLiteral() {
+    token_ = Token::None;
+    if(text_ == "true") handler_.boolValue(true);
+    else if(text_ == "false") handler_.boolValue(false);
+    else handler_.nullValue();
+    return valueDone();
+}
+
+void JsonStreamParser::appendCodePoint(unsigned cp) {
+    if(cp < 0x80) {
+        text_ += static_cast<char>(cp);
+    } else if(cp < 0x800) {
+        text_ += static_cast<char>(0xC0 | (cp >> 6));
+        text_ += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if(cp < 0x10000) {
+        text_ += static_cast<char>(0xE0 | (cp >> 12));
+        text_ += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        text_ += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        text_ += static_cast<char>(0xF0 | (cp >> 18));
+        text_ += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        text_ += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        text_ += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Stands in for a surrogate escape that has no other half
+void JsonStreamParser::unpairedSurrogate() {
+    appendCodePoint(0xFFFD);
+    highSurrogate_ = 0;
+}
+
+Json::Value &JsonValueBuilder::place(Json::Value &&value) {
+    if(stack_.empty()) {
+        root_ = std::move(value);
+        return root_;
+    }
+    Json::Value &parent = *stack_.back();
+    if(parent.isArray()) return parent.append(std::move(value));
+    Json::Value &slot = parent[pendingKey_];
+    slot = std::move(value);
+    return slot;
+}
+
+void JsonValueBuilder::startObject() {
+    stack_.push_back(&place(Json::Value(Json::objectValue)));
+}
+
+void JsonValueBuilder::endObject() {
+    stack_.pop_back();
+}
+
+void JsonValueBuilder::startArray() {
+    stack_.push_back(&place(Json::Value(Json::arrayValue)));
+}
+
+void JsonValueBuilder::endArray() {
+    stack_.pop_back();
+}
+
+void JsonValueBuilder::key(std::string &&name) {
+    pendingKey_ = std::move(name);
+}
+
+void JsonValueBuilder::stringValue(std::string &&value) {
+    place(Json::Value(value));
+}
+
+void JsonValueBuilder::numberValue(const std::string &text) {
+    // Keep integers as integers so asInt()/asString() behave as with Json::Reader
+    if(text.find_first_of(".eE") == std::string::npos) {
+        bool negative = text[0] == '-';
+        errno = 0;
+        Json::UInt64 magnitude = std::strtoull(text.c_str() + negative, nullptr, 10);
+        const Json::UInt64 maxInt64 = static_cast<Json::UInt64>(Json::Value::maxInt64);
+        if(errno != ERANGE) {
+            if(magnitude <= maxInt64) {
+                Json::Int64 value = static_cast<Json::Int64>(magnitude);
+                place(Json::Value(negative ? -value : value));
+                return;
+            }
+            if(!negative) {
+                place(Json::Value(magnitude));
+                return;
+            }
+            // -2^63 fits an Int64 even though its magnitude does not
+            if(magnitude == maxInt64 + 1) {
+                place(Json::Value(Json::Value::minInt64));
+                return;
+            }
+        }
+        // Past 64 bits: read it as a double, as Json::Reader does
+    }
+    place(Json::Value(std::strtod(text.c_str(), nullptr)));
+}
+
+void JsonValueBuilder::boolValue(bool value) {
+    place(Json::Value(value));
+}
+
+void JsonValueBuilder::nullValue() {
+    place(Json::Value());
+}
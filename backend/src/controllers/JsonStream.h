@@ -0,0 +1,90 @@
+#pragma once
+#include <json/json.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+    What is JsonStream?
+    A small event-driven (SAX style) JSON parser that accepts its input in arbitrary chunks,
+    so a Supabase response can be parsed straight from the curl write callback as the bytes
+    arrive instead of being buffered into one string and parsed afterwards.
+
+    JsonStreamParser reports what it reads to a JsonSaxHandler. JsonValueBuilder is the
+    handler used for ordinary responses: it assembles the Json::Value the rest of the code
+    already works with.
+*/
+
+class JsonSaxHandler {
+public:
+    virtual ~JsonSaxHandler() = default;
+    virtual void startObject() {}
+    virtual void endObject() {}
+    virtual void startArray() {}
+    virtual void endArray() {}
+    virtual void key(std::string &&) {}
+    virtual void stringValue(std::string &&) {}
+    // numbers are reported exactly as written in the document
+    virtual void numberValue(const std::string &) {}
+    virtual void boolValue(bool) {}
+    virtual void nullValue() {}
+};
+
+class JsonStreamParser {
+public:
+    explicit JsonStreamParser(JsonSaxHandler &handler) : handler_(handler) {}
+
+    // Parse the next chunk of the document. Returns false once the input is not valid JSON
+    bool feed(const char *data, size_t size);
+    // Call after the last chunk. Returns true only if exactly one complete value was read
+    bool finish();
+
+    const std::string &error() const { return error_; }
+
+private:
+    enum class Expect { Value, ValueOrEnd, KeyOrEnd, Key, Colon, CommaOrEnd, Done };
+    enum class Token { None, String, StringEscape, StringUnicode, StringSurrogate, Number, Literal };
+
+    bool step(char c);
+    bool fail(const std::string &what);
+    bool valueDone();
+    bool closeContainer(char c);
+    bool finishString();
+    bool finishNumber();
+    bool finishLiteral();
+    void appendCodePoint(unsigned codePoint);
+    void unpairedSurrogate();
+
+    JsonSaxHandler &handler_;
+    std::vector<char> stack_;           // '{' or '[' for every open container
+    Expect expect_ = Expect::Value;
+    Token token_ = Token::None;
+    bool tokenIsKey_ = false;
+    std::string text_;                  // string, number or literal being read
+    std::string unicode_;               // hex digits of a \u escape being read
+    unsigned highSurrogate_ = 0;        // a \u escape of a high surrogate, until its low half
+    std::string error_;
+};
+
+// Builds a Json::Value from parser events
+class JsonValueBuilder : public JsonSaxHandler {
+public:
+    void startObject() override;
+    void endObject() override;
+    void startArray() override;
+    void endArray() override;
+    void key(std::string &&name) override;
+    void stringValue(std::string &&value) override;
+    void numberValue(const std::string &text) override;
+    void boolValue(bool value) override;
+    void nullValue() override;
+
+    Json::Value &result() { return root_; }
+
+private:
+    Json::Value &place(Json::Value &&value);
+
+    Json::Value root_;
+    std::vector<Json::Value*> stack_;
+    std::string pendingKey_;
+};
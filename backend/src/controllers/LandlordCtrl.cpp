@@ -1,5 +1,10 @@
 #include "LandlordCtrl.h"
 #include "SupabaseHelper.h"
+#include "Catalog.h"
+#include "RatingStore.h"
+#include "SuggestIndex.h"
+#include "Projection.h"
+#include <trantor/net/EventLoopThread.h>
 #include <fstream>
 #include <algorithm>
 #include <map>
@@ -7,174 +12,705 @@
 #include <cmath>
 #include <ctime>
 #include <cstdio> 
+#include <cctype>
+#include <limits>
+#include <optional>
+#include <cstdlib>
+#include <functional>
+#include <exception>
 
-static std::string lower(std::string s){
-    std::transform(s.begin(), s.end(), s.begin(),
-                   [](unsigned char c){ return std::tolower(c); });
-    return s;
+// Helper: a landlord's response object with its average_rating and review_count attached
+static Json::Value landlordEntry(const Catalog &catalog, const Landlord &landlord, double &avgRating)
+{
+    Json::Value entry = catalog.toJson(landlord);
+    LandlordRating rating = RatingStore::instance().get(landlord.key);
+    avgRating = rating.average();
+    entry["average_rating"] = std::round(avgRating * 100.0) / 100.0; // Round to 2 decimal places
+    entry["review_count"] = rating.count;
+    return entry;
+}
+
+// Helper: the figures a projected landlord entry reads, rounded as in landlordEntry
+static LandlordFigures landlordFigures(const Landlord &landlord)
+{
+    LandlordRating rating = RatingStore::instance().get(landlord.key);
+    LandlordFigures figures;
+    figures.averageRating = std::round(rating.average() * 100.0) / 100.0;
+    figures.reviewCount = rating.count;
+    return figures;
+}
+
+// Helper: compile the fields= parameter of a request, if it has one; false if it names an
+// unknown field, with a 400 already sent
+static bool projectionFor(const drogon::HttpRequestPtr &req, std::shared_ptr<const Projection> &projection,
+                          const std::function<void (const drogon::HttpResponsePtr &)> &cb)
+{
+    std::string fields = req->getParameter("fields");
+    if(fields.empty()) return true;
+    std::string error;
+    projection = Projection::compile(fields, error);
+    if(projection) return true;
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+    resp->setStatusCode(drogon::k400BadRequest);
+    (*resp->getJsonObject())["error"] = error;
+    cb(resp);
+    return false;
+}
+
+// Helper: answer with a 500 when the landlord catalog could not be loaded
+static void catalogError(const std::function<void (const drogon::HttpResponsePtr &)> &cb, const std::string &err)
+{
+    LOG_ERROR << "Failed to load the landlord catalog from Supabase: " << err;
+    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+    resp->setStatusCode(drogon::k500InternalServerError);
+    (*resp->getJsonObject())["error"] = "failed to load catalog: " + err;
+    cb(resp);
+}
+
+// Helper: a response whose JSON body was written as text already
+static drogon::HttpResponsePtr jsonTextResponse(std::string &&body)
+{
+    auto resp = drogon::HttpResponse::newHttpResponse();
+    resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+    resp->setBody(std::move(body));
+    return resp;
 }
 
-// Helper: load reviews from Supabase and compute per-landlord (sum, count)
-static std::map<std::string, std::pair<double,int>> computeLandlordRatings()
+// Helper: how many typos fuzzy search tolerates for a query of this length
+static int fuzzyDistance(size_t length)
 {
-    std::map<std::string, std::pair<double,int>> ratings;
-    
-    // Get all reviews from Supabase
-    Json::Value reviewsArray;
-    std::string err;
-    if(!SupabaseHelper::getAllReviews(reviewsArray, err)) {
-        LOG_ERROR << "Failed to load reviews for rating computation: " << err;
-        return ratings; // Return empty map if Supabase fails
+    if(length < 3) return 0;
+    if(length < 6) return 1;
+    return 2;
+}
+
+// Helper: fuzzy matches by catalog position: exact substring matches count as distance 0,
+// the rest by edit distance
+static std::map<uint32_t, int> fuzzyMatches(const Catalog &catalog, const std::string &query)
+{
+    std::map<uint32_t, int> distances;
+    for(const auto &match : catalog.searchNamesFuzzy(query, fuzzyDistance(query.size()))) {
+        distances[match.position] = match.distance;
     }
+    for(uint32_t i : catalog.searchNames(query)) distances[i] = 0;
+    return distances;
+}
 
-    // Compute ratings from Supabase reviews
-    for (const auto &review : reviewsArray) {
-        std::string landlordId = review["landlord_id"].asString();
-        int rating = review["rating"].asInt();
-        if (ratings.find(landlordId) == ratings.end()) {
-            ratings[landlordId] = std::make_pair(0.0, 0);
-        }
-        ratings[landlordId].first += rating;
-        ratings[landlordId].second += 1;
+// Orders search can return results in
+enum class SearchSort {
+    Relevance,  // catalog order; for fuzzy search by distance, then rating
+    Rating,     // highest average rating first
+    Reviews,    // most reviews first
+    Name        // by name, ignoring case
+};
+
+// One search match with what its sort keys need
+struct SearchMatch {
+    uint32_t position;      // in Catalog::landlords
+    int distance;           // edit distance for fuzzy search, else 0
+    double rating;
+    uint32_t reviews;
+};
+
+// Helper: strict weak order of search matches for a sort; catalog position breaks ties, so
+// the order is total and a cursor names an exact place in it
+static std::function<bool (const SearchMatch &, const SearchMatch &)> searchOrder(const Catalog &catalog, SearchSort sort, bool fuzzy)
+{
+    switch(sort) {
+    case SearchSort::Rating:
+        return [](const SearchMatch &a, const SearchMatch &b) {
+            if(a.rating != b.rating) return a.rating > b.rating;
+            if(a.reviews != b.reviews) return a.reviews > b.reviews;
+            return a.position < b.position;
+        };
+    case SearchSort::Reviews:
+        return [](const SearchMatch &a, const SearchMatch &b) {
+            if(a.reviews != b.reviews) return a.reviews > b.reviews;
+            if(a.rating != b.rating) return a.rating > b.rating;
+            return a.position < b.position;
+        };
+    case SearchSort::Name:
+        return [&catalog](const SearchMatch &a, const SearchMatch &b) {
+            const std::string &x = catalog.landlords[a.position].name;
+            const std::string &y = catalog.landlords[b.position].name;
+            auto mismatch = std::mismatch(x.begin(), x.end(), y.begin(), y.end(), [](unsigned char c, unsigned char d) {
+                return std::tolower(c) == std::tolower(d);
+            });
+            if(mismatch.first != x.end() || mismatch.second != y.end()) {
+                if(mismatch.first == x.end()) return true;
+                if(mismatch.second == y.end()) return false;
+                return std::tolower(static_cast<unsigned char>(*mismatch.first)) < std::tolower(static_cast<unsigned char>(*mismatch.second));
+            }
+            return a.position < b.position;
+        };
+    case SearchSort::Relevance:
+        break;
     }
+    if(fuzzy) {
+        return [](const SearchMatch &a, const SearchMatch &b) {
+            if(a.distance != b.distance) return a.distance < b.distance;
+            if(a.rating != b.rating) return a.rating > b.rating;
+            return a.position < b.position;
+        };
+    }
+    return [](const SearchMatch &a, const SearchMatch &b) { return a.position < b.position; };
+}
 
-    return ratings;
+// Helper: parse an optional non-negative integer query parameter; false if it is malformed
+static bool parseCount(const std::string &text, size_t &value)
+{
+    if(text.empty()) return true;
+    if(text.size() > 9 || !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return false;
+    }
+    value = std::stoul(text);
+    return true;
 }
 
 void LandlordCtrl::search(const drogon::HttpRequestPtr &req,
                           std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
-    auto q = req->getParameter("name");
-    std::string query = lower(q);
-
-    // Get all landlords from Supabase
-    Json::Value landlordsJson;
-    std::string err;
-    if(!SupabaseHelper::getAllLandlords(landlordsJson, err)) {
-        LOG_ERROR << "Failed to get landlords from Supabase: " << err;
+    // Case folding happens in the catalog's name index
+    std::string query = req->getParameter("name");
+    bool fuzzy = req->getParameter("fuzzy") == "1";
+
+    // Without limit every match is returned, as before pagination existed. A cursor is the
+    // landlord_id of the last result of the previous page; offset then counts from it
+    size_t offset = 0;
+    size_t limit = std::numeric_limits<size_t>::max();
+    std::string sortParam = req->getParameter("sort");
+    std::string cursor = req->getParameter("cursor");
+    if(!parseCount(req->getParameter("offset"), offset) || !parseCount(req->getParameter("limit"), limit)
+       || (!sortParam.empty() && sortParam != "rating" && sortParam != "reviews" && sortParam != "name")) {
         auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "failed to load landlords: " + err;
+        resp->setStatusCode(drogon::k400BadRequest);
+        (*resp->getJsonObject())["error"] = "limit and offset must be non-negative integers and sort one of rating, reviews, name";
         cb(resp);
         return;
     }
+    SearchSort sort = sortParam == "rating" ? SearchSort::Rating
+                    : sortParam == "reviews" ? SearchSort::Reviews
+                    : sortParam == "name" ? SearchSort::Name
+                    : SearchSort::Relevance;
+    std::shared_ptr<const Projection> projection;
+    if(!projectionFor(req, projection, cb)) return;
 
-    // Compute ratings map once and attach to results
-    auto landlordRatings = computeLandlordRatings();
-
-    Json::Value results(Json::arrayValue);
-    for(const auto &ll : landlordsJson){
-        std::string name = ll["name"].asString();
-        if(query.empty() || lower(name).find(query) != std::string::npos){
-            Json::Value landlord = ll;
-            std::string landlordId = ll["landlord_id"].asString();
-            double avgRating = 0.0;
-            int reviewCount = 0;
-            auto it = landlordRatings.find(landlordId);
-            if(it != landlordRatings.end() && it->second.second > 0){
-                avgRating = it->second.first / it->second.second;
-                reviewCount = it->second.second;
+    // Ratings come from the resident aggregates; this only waits if they are not loaded yet
+    RatingStore::instance().whenReady([query, fuzzy, offset, limit, sort, cursor, projection, cb = std::move(cb)]() {
+        // Get all landlords from Supabase
+        SupabaseHelper::getAllLandlords([query, fuzzy, offset, limit, sort, cursor, projection, cb](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+            if(!ok) {
+                catalogError(cb, err);
+                return;
             }
-            landlord["average_rating"] = std::round(avgRating * 100.0) / 100.0;
-            landlord["review_count"] = reviewCount;
-            results.append(landlord);
-        }
-    }
 
-    // Create a json object to send back
-    Json::Value body(Json::objectValue);
-    // define entry "results" to the array of names we just captured
-    body["results"] = results;
-    // format response to a drogon http response object
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+            // Matches come from the catalog's trigram index (and BK-tree when fuzzy), with
+            // only the keys needed to order them
+            bool useFuzzy = fuzzy && !query.empty();
+            std::vector<SearchMatch> matches;
+            auto addMatch = [&](uint32_t position, int distance) {
+                LandlordRating rating = RatingStore::instance().get(catalog->landlords[position].key);
+                matches.push_back({position, distance, rating.average(), rating.count});
+            };
+            if(useFuzzy) {
+                for(const auto &match : fuzzyMatches(*catalog, query)) addMatch(match.first, match.second);
+            } else {
+                for(uint32_t i : catalog->searchNames(query)) addMatch(i, 0);
+            }
+            size_t total = matches.size();
+            auto less = searchOrder(*catalog, sort, useFuzzy);
 
-    // now inside the reference (call back), but the response object inside
-    cb(resp);
+            // Resume after the cursor's landlord, which has to still be a match
+            if(!cursor.empty()) {
+                const Landlord *last = catalog->findLandlord(cursor);
+                auto found = std::find_if(matches.begin(), matches.end(), [&](const SearchMatch &m) {
+                    return last && m.position == static_cast<uint32_t>(last - catalog->landlords.data());
+                });
+                if(found == matches.end()) {
+                    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                    resp->setStatusCode(drogon::k400BadRequest);
+                    (*resp->getJsonObject())["error"] = "cursor does not name a landlord in these results";
+                    cb(resp);
+                    return;
+                }
+                SearchMatch after = *found;
+                matches.erase(std::remove_if(matches.begin(), matches.end(), [&](const SearchMatch &m) {
+                    return !less(after, m);
+                }), matches.end());
+            }
+
+            // Order only the requested page: nth_element puts the first result of the page in
+            // place with everything before it ahead, then partial_sort orders just the page
+            size_t first = std::min(offset, matches.size());
+            size_t count = std::min(limit, matches.size() - first);
+            bool natural = sort == SearchSort::Relevance && !useFuzzy;    // already in catalog order
+            if(!natural) {
+                if(first > 0 && first < matches.size()) {
+                    std::nth_element(matches.begin(), matches.begin() + first, matches.end(), less);
+                }
+                std::partial_sort(matches.begin() + first, matches.begin() + first + count, matches.end(), less);
+            }
+
+            bool more = count > 0 && first + count < matches.size();
+
+            // With fields= the page is written straight from the catalog as JSON text
+            if(projection) {
+                std::string out = "{\"total\":" + std::to_string(total) + ",\"results\":[";
+                for(size_t i = first; i < first + count; i++) {
+                    if(i > first) out += ',';
+                    const Landlord &landlord = catalog->landlords[matches[i].position];
+                    LandlordFigures figures = landlordFigures(landlord);
+                    if(useFuzzy) figures.distance = matches[i].distance;
+                    projection->write(out, *catalog, landlord, figures);
+                }
+                out += ']';
+                if(more) {
+                    out += ",\"next_cursor\":";
+                    Projection::writeString(out, catalog->landlords[matches[first + count - 1].position].landlordId);
+                }
+                out += '}';
+                cb(jsonTextResponse(std::move(out)));
+                return;
+            }
+
+            Json::Value results(Json::arrayValue);
+            for(size_t i = first; i < first + count; i++) {
+                double avgRating;
+                Json::Value entry = landlordEntry(*catalog, catalog->landlords[matches[i].position], avgRating);
+                if(useFuzzy) entry["distance"] = matches[i].distance;
+                results.append(std::move(entry));
+            }
+
+            // Create a json object to send back
+            Json::Value body(Json::objectValue);
+            body["total"] = static_cast<Json::UInt64>(total);
+            // define entry "results" to the page of matches we just captured
+            body["results"] = results;
+            if(more) {
+                body["next_cursor"] = catalog->landlords[matches[first + count - 1].position].landlordId;
+            }
+            // format response to a drogon http response object
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+
+            // now inside the reference (call back), but the response object inside
+            cb(resp);
+        });
+    });
 }
 
 void LandlordCtrl::stats(const drogon::HttpRequestPtr &req,
                         std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
-    int landlordCount = 0;
-    int propertyCount = 0;
-    int unitCount = 0;
-    std::string err;
-    
-    if(!SupabaseHelper::getLandlordStats(landlordCount, propertyCount, unitCount, err)) {
-        LOG_ERROR << "Failed to get landlord stats from Supabase: " << err;
+    SupabaseHelper::getLandlordStats([cb = std::move(cb)](bool ok, const Json::Value &counts, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to get landlord stats from Supabase: " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "failed to load stats: " + err;
+            cb(resp);
+            return;
+        }
+
+        Json::Value body(Json::objectValue);
+        body["landlords"] = counts["landlords"].asInt();
+        body["properties"] = counts["properties"].asInt();
+        body["units"] = counts["units"].asInt();
+
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+        cb(resp);
+    });
+}
+
+void LandlordCtrl::leaderboard(const drogon::HttpRequestPtr &req,
+                                std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+    // Without limit the whole leaderboard is returned, as before pagination existed
+    size_t offset = 0;
+    size_t limit = std::numeric_limits<size_t>::max();
+    std::string orderParam = req->getParameter("order");
+    std::string landlordId = req->getParameter("landlord_id");
+    if(!parseCount(req->getParameter("offset"), offset) || !parseCount(req->getParameter("limit"), limit)
+       || (!orderParam.empty() && orderParam != "rating" && orderParam != "reviews")) {
         auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "failed to load stats: " + err;
+        resp->setStatusCode(drogon::k400BadRequest);
+        (*resp->getJsonObject())["error"] = "limit and offset must be non-negative integers and order one of rating, reviews";
         cb(resp);
         return;
     }
+    RankOrder order = orderParam == "reviews" ? RankOrder::Reviews : RankOrder::Rating;
+    std::shared_ptr<const Projection> projection;
+    if(!projectionFor(req, projection, cb)) return;
+
+    RatingStore::instance().whenReady([cb = std::move(cb), offset, limit, order, landlordId, projection]() {
+        // Load landlords data from Supabase
+        SupabaseHelper::getAllLandlords([cb, offset, limit, order, landlordId, projection](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+            if(!ok) {
+                catalogError(cb, err);
+                return;
+            }
 
-    Json::Value body(Json::objectValue);
-    body["landlords"] = landlordCount;
-    body["properties"] = propertyCount;
-    body["units"] = unitCount;
+            // The rankings follow rating changes as they happen; SupabaseHelper adds and
+            // removes landlords as it publishes each catalog snapshot
+            RatingStore &store = RatingStore::instance();
 
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
-    cb(resp);
+            Json::Value body(Json::objectValue);
+            body["total"] = static_cast<Json::UInt64>(store.rankedCount());
+
+            // Rank of one landlord
+            if(!landlordId.empty()) {
+                const Landlord *landlord = catalog->findLandlord(landlordId);
+                long rank = landlord ? store.rankOf(order, landlord->key) : -1;
+                if(rank < 0 || !landlord) {
+                    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                    resp->setStatusCode(drogon::k404NotFound);
+                    (*resp->getJsonObject())["error"] = "Landlord not found";
+                    cb(resp);
+                    return;
+                }
+                if(projection) {
+                    LandlordFigures figures = landlordFigures(*landlord);
+                    figures.rank = static_cast<uint64_t>(rank + 1);
+                    std::string out = "{\"total\":" + std::to_string(store.rankedCount()) + ",\"landlord\":";
+                    projection->write(out, *catalog, *landlord, figures);
+                    out += '}';
+                    cb(jsonTextResponse(std::move(out)));
+                    return;
+                }
+                double avgRating;
+                Json::Value entry = landlordEntry(*catalog, *landlord, avgRating);
+                entry["rank"] = static_cast<Json::Int64>(rank + 1);
+                body["landlord"] = entry;
+                cb(drogon::HttpResponse::newHttpJsonResponse(body));
+                return;
+            }
+
+            // One page of the leaderboard, ranks are 1-based
+            if(projection) {
+                std::string out = "{\"total\":" + std::to_string(store.rankedCount()) + ",\"leaderboard\":[";
+                size_t rank = offset;
+                bool first = true;
+                for(uint32_t key : store.ranked(order, offset, limit)) {
+                    const Landlord *landlord = catalog->findLandlord(key);
+                    if(!landlord) continue;
+                    rank++;
+                    if(!first) out += ',';
+                    first = false;
+                    LandlordFigures figures = landlordFigures(*landlord);
+                    figures.rank = rank;
+                    projection->write(out, *catalog, *landlord, figures);
+                }
+                out += "]}";
+                cb(jsonTextResponse(std::move(out)));
+                return;
+            }
+
+            Json::Value sortedResults(Json::arrayValue);
+            size_t rank = offset;
+            for (uint32_t key : store.ranked(order, offset, limit)) {
+                const Landlord *landlord = catalog->findLandlord(key);
+                if(!landlord) continue;
+                rank++;
+                double avgRating;
+                Json::Value entry = landlordEntry(*catalog, *landlord, avgRating);
+                entry["rank"] = static_cast<Json::UInt64>(rank);
+                sortedResults.append(std::move(entry));
+            }
+
+            body["leaderboard"] = sortedResults;
+
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+            cb(resp);
+        });
+    });
 }
 
-void LandlordCtrl::leaderboard(const drogon::HttpRequestPtr &req,
-                                std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
-    // Load landlords data from Supabase
-    Json::Value landlordsArray;
-    std::string err;
-    if(!SupabaseHelper::getAllLandlords(landlordsArray, err)) {
-        LOG_ERROR << "Failed to get landlords from Supabase: " << err;
+// Rating changes alone re-rank the type-ahead index at most this often
+static const std::chrono::seconds SUGGEST_RERANK_INTERVAL(5);
+
+// Building the trie for a large catalog takes long enough to stall an event loop, so it
+// happens on a thread of its own
+static trantor::EventLoop *suggestBuildLoop()
+{
+    static trantor::EventLoopThread thread("SuggestIndexBuild");
+    static std::once_flag started;
+    std::call_once(started, []() { thread.run(); });
+    return thread.getLoop();
+}
+
+void LandlordCtrl::withSuggestions(const std::shared_ptr<const Catalog> &catalog, SuggestionsCallback done)
+{
+    uint64_t version = RatingStore::instance().version();
+    auto now = std::chrono::steady_clock::now();
+
+    std::shared_ptr<const Suggestions> current;
+    bool startBuild = false;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        current = suggestions_;
+        bool fresh = current && current->catalog == catalog
+                     && (version == current->version || now - current->builtAt < SUGGEST_RERANK_INTERVAL);
+        if(!current) {
+            // Hand done back to the event loop of the request that is waiting
+            auto *loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+            if(loop) {
+                suggestWaiters_.push_back([loop, done = std::move(done)](const std::shared_ptr<const Suggestions> &built) {
+                    loop->queueInLoop([done, built]() { done(built); });
+                });
+            } else {
+                suggestWaiters_.push_back(std::move(done));
+            }
+            done = nullptr;
+        }
+        if(!fresh && !suggestRebuilding_) {
+            suggestRebuilding_ = true;
+            startBuild = true;
+        }
+    }
+    if(startBuild) suggestBuildLoop()->queueInLoop([this, catalog]() { rebuildSuggestions(catalog); });
+    // A stale index still answers from the snapshot it was built for until the new one is in
+    if(done) done(current);
+}
+
+void LandlordCtrl::rebuildSuggestions(const std::shared_ptr<const Catalog> &catalog)
+{
+    RatingStore &store = RatingStore::instance();
+    std::shared_ptr<Suggestions> built;
+    try {
+        built = std::make_shared<Suggestions>();
+        built->catalog = catalog;
+        built->version = store.version();
+        built->builtAt = std::chrono::steady_clock::now();
+
+        std::vector<std::pair<double, uint32_t>> scores;
+        scores.reserve(catalog->landlords.size());
+        for(const auto &landlord : catalog->landlords) {
+            LandlordRating rating = store.get(landlord.key);
+            scores.push_back({rating.average(), rating.count});
+        }
+        built->index = std::make_shared<const SuggestIndex>(*catalog, scores);
+    } catch(const std::exception &e) {
+        // Keep serving the index there is; the next request that finds it stale tries again
+        LOG_ERROR << "Failed to build the suggestion index: " << e.what();
+        built = nullptr;
+    }
+
+    std::shared_ptr<const Suggestions> current;
+    std::vector<SuggestionsCallback> waiters;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if(built) suggestions_ = built;
+        current = suggestions_;
+        suggestRebuilding_ = false;
+        waiters.swap(suggestWaiters_);
+    }
+    // Requests only wait while there is no index at all, so after a failed first build
+    // they are answered with none
+    for(auto &waiter : waiters) waiter(current);
+}
+
+void LandlordCtrl::suggest(const drogon::HttpRequestPtr &req,
+                           std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+    std::string query = req->getParameter("q");
+    size_t limit = SuggestIndex::TOP_K;
+    if(!parseCount(req->getParameter("limit"), limit)) {
         auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "failed to load landlords: " + err;
+        resp->setStatusCode(drogon::k400BadRequest);
+        (*resp->getJsonObject())["error"] = "limit must be a non-negative integer";
         cb(resp);
         return;
     }
+    limit = std::min(limit, SuggestIndex::TOP_K);
 
-    // Compute ratings map once (sum,count) using helper
-    auto landlordRatings = computeLandlordRatings();
+    // Nothing typed yet, nothing to suggest
+    if(query.empty()) {
+        Json::Value body(Json::objectValue);
+        body["suggestions"] = Json::Value(Json::arrayValue);
+        cb(drogon::HttpResponse::newHttpJsonResponse(body));
+        return;
+    }
 
-    // Create leaderboard entries
-    Json::Value results(Json::arrayValue);
-    std::vector<std::pair<std::string, double>> sortedLandlords;
+    RatingStore::instance().whenReady([this, query, limit, cb = std::move(cb)]() {
+        SupabaseHelper::getAllLandlords([this, query, limit, cb](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+            if(!ok) {
+                catalogError(cb, err);
+                return;
+            }
 
-    for (const auto &ll : landlordsArray) {
-        std::string landlordId = ll["landlord_id"].asString();
-        double avgRating = 0.0;
-        int reviewCount = 0;
+            withSuggestions(catalog, [query, limit, cb](const std::shared_ptr<const Suggestions> &built) {
+                if(!built) {
+                    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                    resp->setStatusCode(drogon::k500InternalServerError);
+                    (*resp->getJsonObject())["error"] = "failed to build suggestions";
+                    cb(resp);
+                    return;
+                }
 
-        if (landlordRatings.find(landlordId) != landlordRatings.end()) {
-            avgRating = landlordRatings[landlordId].first / landlordRatings[landlordId].second;
-            reviewCount = landlordRatings[landlordId].second;
-        }
+                // Only {id, name, rating}: type-ahead does not need the full landlord records
+                Json::Value suggestions(Json::arrayValue);
+                for(uint32_t i : built->index->lookup(query, limit)) {
+                    const Landlord &landlord = built->catalog->landlords[i];
+                    Json::Value suggestion(Json::objectValue);
+                    suggestion["id"] = landlord.landlordId;
+                    suggestion["name"] = landlord.name;
+                    suggestion["rating"] = std::round(RatingStore::instance().get(landlord.key).average() * 100.0) / 100.0;
+                    suggestions.append(suggestion);
+                }
+
+                Json::Value body(Json::objectValue);
+                body["suggestions"] = suggestions;
+                cb(drogon::HttpResponse::newHttpJsonResponse(body));
+            });
+        });
+    });
+}
+
+void LandlordCtrl::detail(const drogon::HttpRequestPtr &req,
+                          std::function<void (const drogon::HttpResponsePtr &)> &&cb,
+                          const std::string &landlordId) {
+    // Both the catalog and the ratings are resident once loaded, so a warm lookup is an
+    // index probe into each and never calls Supabase
+    RatingStore::instance().whenReady([landlordId, cb = std::move(cb)]() {
+        SupabaseHelper::getAllLandlords([landlordId, cb](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+            if(!ok) {
+                catalogError(cb, err);
+                return;
+            }
+
+            const Landlord *landlord = catalog->findLandlord(landlordId);
+            if(!landlord) {
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                resp->setStatusCode(drogon::k404NotFound);
+                (*resp->getJsonObject())["error"] = "Landlord not found";
+                cb(resp);
+                return;
+            }
 
-        // Create leaderboard entry
-        Json::Value entry = ll;
-        entry["average_rating"] = std::round(avgRating * 100.0) / 100.0; // Round to 2 decimal places
-        entry["review_count"] = reviewCount;
-        sortedLandlords.push_back({landlordId, avgRating});
-        results.append(entry);
+            double avgRating;
+            Json::Value entry = landlordEntry(*catalog, *landlord, avgRating);
+            LandlordRating rating = RatingStore::instance().get(landlord->key);
+            Json::Value histogram(Json::objectValue);
+            for(int r = 1; r <= 5; r++) histogram[std::to_string(r)] = rating.histogram[r - 1];
+            entry["rating_histogram"] = histogram;
+            entry["property_count"] = landlord->propertyCount;
+            entry["unit_count"] = landlord->unitCount;
+            cb(drogon::HttpResponse::newHttpJsonResponse(entry));
+        });
+    });
+}
+
+// Helper: parse an optional numeric query parameter; false if it is malformed
+static bool parseNumber(const std::string &text, std::optional<double> &value)
+{
+    if(text.empty()) return true;
+    char *end = nullptr;
+    double parsed = std::strtod(text.c_str(), &end);
+    if(end != text.c_str() + text.size() || !std::isfinite(parsed)) return false;
+    value = parsed;
+    return true;
+}
+
+void LandlordCtrl::searchProperties(const drogon::HttpRequestPtr &req,
+                                    std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+    FacetQuery query;
+    query.city = req->getParameter("city");
+    query.province = req->getParameter("province");
+    size_t minBedrooms = 0, maxBedrooms = 0;
+    std::string minBed = req->getParameter("min_bed");
+    std::string maxBed = req->getParameter("max_bed");
+    if(!parseCount(minBed, minBedrooms) || !parseCount(maxBed, maxBedrooms)
+       || !parseNumber(req->getParameter("min_rent"), query.minRent)
+       || !parseNumber(req->getParameter("max_rent"), query.maxRent)) {
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+        resp->setStatusCode(drogon::k400BadRequest);
+        (*resp->getJsonObject())["error"] = "min_bed and max_bed must be non-negative integers and min_rent and max_rent numbers";
+        cb(resp);
+        return;
     }
+    if(!minBed.empty()) query.minBedrooms = static_cast<int>(minBedrooms);
+    if(!maxBed.empty()) query.maxBedrooms = static_cast<int>(maxBedrooms);
+    std::string address = req->getParameter("address");
 
-    // Sort results by average rating (highest to lowest)
-    // We need to reorder the results array
-    std::sort(sortedLandlords.begin(), sortedLandlords.end(), 
-              [](const auto &a, const auto &b) { return a.second > b.second; });
+    SupabaseHelper::getAllLandlords([query, address, cb = std::move(cb)](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+        if(!ok) {
+            catalogError(cb, err);
+            return;
+        }
 
-    Json::Value sortedResults(Json::arrayValue);
-    for (const auto &sorted : sortedLandlords) {
-        for (const auto &entry : results) {
-            if (entry["landlord_id"].asString() == sorted.first) {
-                sortedResults.append(entry);
-                break;
+        const UnitStore &store = catalog->unitStore();
+        const FacetIndex &facets = catalog->facets();
+        Bitmap units = facets.match(store, query);
+
+        // address= keeps the units of properties whose address contains it; a property's
+        // units are consecutive, so the bitmap is built in order
+        if(!address.empty()) {
+            Bitmap addressUnits;
+            for(uint32_t p : catalog->searchAddresses(address)) {
+                const Property &prop = catalog->properties[p];
+                for(uint32_t u = prop.firstUnit; u < prop.firstUnit + prop.unitCount; u++) addressUnits.append(u);
             }
+            units = units & addressUnits;
         }
-    }
 
-    Json::Value body(Json::objectValue);
-    body["leaderboard"] = sortedResults;
-    
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
-    cb(resp);
+        // Matching units come in catalog order, so the units of one property are adjacent;
+        // each property is listed once with only its matching units
+        Json::Value results(Json::arrayValue);
+        uint32_t current = 0;
+        Json::Value *property = nullptr;
+        for(uint32_t u : units.values()) {
+            uint32_t p = store.property[u];
+            if(!property || p != current) {
+                const Landlord &landlord = catalog->landlords[store.propertyLandlord[p]];
+                Json::Value entry = catalog->toJson(catalog->properties[p]);
+                entry["unit_details"] = Json::Value(Json::arrayValue);
+                entry["landlord_id"] = landlord.landlordId;
+                entry["landlord_name"] = landlord.name;
+                property = &results.append(entry);
+                current = p;
+            }
+            (*property)["unit_details"].append(Catalog::toJson(catalog->units[u]));
+        }
+
+        Json::Value body(Json::objectValue);
+        body["total"] = results.size();
+        body["units"] = units.cardinality();
+        body["results"] = results;
+        body["facets"] = facets.counts(store, units);
+        cb(drogon::HttpResponse::newHttpJsonResponse(body));
+    });
+}
+
+void LandlordCtrl::propertyStats(const drogon::HttpRequestPtr &req,
+                                 std::function<void (const drogon::HttpResponsePtr &)> &&cb) {
+    SupabaseHelper::getAllLandlords([cb = std::move(cb)](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+        if(!ok) {
+            catalogError(cb, err);
+            return;
+        }
+
+        // Per-city figures come straight from the rent and city columns
+        const UnitStore &store = catalog->unitStore();
+        std::vector<UnitStore::CityStats> stats = store.cityStats();
+        Json::Value cities(Json::arrayValue);
+        for(uint32_t c = 0; c < stats.size(); c++) {
+            if(stats[c].units == 0) continue;
+            Json::Value city(Json::objectValue);
+            city["city"] = store.cities()[c];
+            city["units"] = stats[c].units;
+            city["average_rent"] = static_cast<double>(stats[c].rentCentsSum) / stats[c].units / 100;
+            city["min_rent"] = stats[c].minRentCents / 100.0;
+            city["max_rent"] = stats[c].maxRentCents / 100.0;
+            cities.append(city);
+        }
+
+        // Footprint of the columns next to the structs and the JSON catalog they replace
+        Json::Value memory(Json::objectValue);
+        memory["unit_store_bytes"] = static_cast<Json::UInt64>(store.memoryBytes());
+        memory["catalog_bytes"] = static_cast<Json::UInt64>(catalog->memoryBytes());
+        memory["catalog_json_bytes"] = static_cast<Json::UInt64>(catalog->jsonBytes());
+
+        Json::Value body(Json::objectValue);
+        body["units"] = store.size();
+        body["cities"] = cities;
+        body["memory"] = memory;
+        cb(drogon::HttpResponse::newHttpJsonResponse(body));
+    });
 }
 
 void LandlordCtrl::submitRequest(const drogon::HttpRequestPtr &req,
@@ -224,7 +760,7 @@ void LandlordCtrl::submitRequest(const drogon::HttpRequestPtr &req,
 
             std::string unitNumber      = p["unit_number"].asString();
             int unitBedrooms            = p["unit_bedrooms"].asInt();
-            int unitBathrooms           = p["unit_bathrooms"].asInt();
+            double unitBathrooms        = p["unit_bathrooms"].asDouble();
             int unitRent                = p["unit_rent"].asInt();
 
             if (propertyAddress.empty() ||
@@ -261,7 +797,7 @@ void LandlordCtrl::submitRequest(const drogon::HttpRequestPtr &req,
 
         std::string unitNumber     = (*json)["unit_number"].asString();
         int unitBedrooms           = (*json)["unit_bedrooms"].asInt();
-        int unitBathrooms          = (*json)["unit_bathrooms"].asInt();
+        double unitBathrooms       = (*json)["unit_bathrooms"].asDouble();
         int unitRent               = (*json)["unit_rent"].asInt();
 
         if (propertyInfo.empty() ||
@@ -291,44 +827,45 @@ void LandlordCtrl::submitRequest(const drogon::HttpRequestPtr &req,
     }
 
     // Insert request into Supabase
-    int requestId = 0;
-    std::string err;
-    if(!SupabaseHelper::insertLandlordRequest(requestId, landlordName, landlordEmail, landlordPhone,
-                                               requesterName, requesterEmail, details, properties, err)) {
-        LOG_ERROR << "Failed to insert landlord request: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to save request: " + err;
-        cb(resp);
-        return;
-    }
+    SupabaseHelper::insertLandlordRequest(landlordName, landlordEmail, landlordPhone,
+                                          requesterName, requesterEmail, details, properties,
+                                          [cb = std::move(cb)](bool ok, const Json::Value &, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to insert landlord request: " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "Failed to save request: " + err;
+            cb(resp);
+            return;
+        }
 
-    Json::Value body(Json::objectValue);
-    body["ok"] = true;
-    body["message"] = "Landlord request submitted";
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
-    cb(resp);
+        Json::Value body(Json::objectValue);
+        body["ok"] = true;
+        body["message"] = "Landlord request submitted";
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+        cb(resp);
+    });
 }
 
 
 void LandlordCtrl::listRequests(const drogon::HttpRequestPtr &req,
                                 std::function<void (const drogon::HttpResponsePtr &)> &&cb)
 {
-    Json::Value requestsArray;
-    std::string err;
-    if(!SupabaseHelper::getAllLandlordRequests(requestsArray, err)) {
-        LOG_ERROR << "Failed to get landlord requests: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to load requests: " + err;
-        cb(resp);
-        return;
-    }
+    SupabaseHelper::getAllLandlordRequests([cb = std::move(cb)](bool ok, const Json::Value &requestsArray, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to get landlord requests: " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "Failed to load requests: " + err;
+            cb(resp);
+            return;
+        }
 
-    Json::Value body(Json::objectValue);
-    body["requests"] = requestsArray;
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
-    cb(resp);
+        Json::Value body(Json::objectValue);
+        body["requests"] = requestsArray;
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+        cb(resp);
+    });
 }
 
 void LandlordCtrl::rejectRequest(const drogon::HttpRequestPtr &req,
@@ -342,88 +879,27 @@ void LandlordCtrl::rejectRequest(const drogon::HttpRequestPtr &req,
     }
 
     // Delete request from Supabase
-    std::string err;
-    if(!SupabaseHelper::deleteLandlordRequest(requestId, err)) {
-        LOG_ERROR << "Failed to delete landlord request " << requestId << ": " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to delete request: " + err;
-        cb(resp);
-        return;
-    }
-
-    Json::Value body(Json::objectValue);
-    body["ok"] = true;
-    body["id"] = requestId;
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
-    cb(resp);
-}
-
-void LandlordCtrl::approveRequest(const drogon::HttpRequestPtr &req,
-                                  std::function<void (const drogon::HttpResponsePtr &)> &&cb,
-                                  int requestId)
-{
-    // Get request from Supabase
-    Json::Value requestsArray;
-    std::string err;
-    if(!SupabaseHelper::getAllLandlordRequests(requestsArray, err)) {
-        LOG_ERROR << "Failed to get landlord requests: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to load requests: " + err;
-        cb(resp);
-        return;
-    }
-
-    Json::Value reqCopy;
-    bool found = false;
-    for(const auto &r : requestsArray) {
-        if(r["id"].asInt() == requestId) {
-            reqCopy = r;
-            found = true;
-            break;
+    SupabaseHelper::deleteLandlordRequest(requestId, [cb = std::move(cb), requestId](bool ok, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to delete landlord request " << requestId << ": " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "Failed to delete request: " + err;
+            cb(resp);
+            return;
         }
-    }
 
-    if(!found) {
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k404NotFound);
-        (*resp->getJsonObject())["error"] = "Request not found";
+        Json::Value body(Json::objectValue);
+        body["ok"] = true;
+        body["id"] = requestId;
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
         cb(resp);
-        return;
-    }
-
-    // Get all landlords to find max ID
-    Json::Value landlordsArray;
-    if(!SupabaseHelper::getAllLandlords(landlordsArray, err)) {
-        LOG_ERROR << "Failed to get landlords: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to load landlords: " + err;
-        cb(resp);
-        return;
-    }
-
-    // Generate new landlord ID
-    int maxId = 0;
-    for(const auto &ll : landlordsArray) {
-        std::string idStr = ll["landlord_id"].asString();
-        if(idStr.rfind("LL", 0) == 0 && idStr.length() >= 3) {
-            try {
-                int num = std::stoi(idStr.substr(2));
-                if(num > maxId) maxId = num;
-            } catch(const std::exception &e) {
-                // Skip invalid IDs
-                continue;
-            }
-        }
-    }
-    int newId = maxId + 1;
-    char buf[16];
-    snprintf(buf, sizeof(buf), "LL%03d", newId);
-    std::string landlordId = buf;
+    });
+}
 
-    // Build properties array from request
+// Helper: turn an approved request into the properties array stored for the new landlord
+static Json::Value buildPropertiesFromRequest(const Json::Value &reqCopy, int newId)
+{
     Json::Value props(Json::arrayValue);
     Json::Value propsFromReq = reqCopy["properties"];
 
@@ -446,7 +922,7 @@ void LandlordCtrl::approveRequest(const drogon::HttpRequestPtr &req,
             Json::Value u(Json::objectValue);
             u["unit_number"] = rp["unit_number"].asString();
             u["bedrooms"] = rp["unit_bedrooms"].asInt();
-            u["bathrooms"] = rp["unit_bathrooms"].asInt();
+            u["bathrooms"] = rp["unit_bathrooms"].asDouble();
             u["rent"] = rp["unit_rent"].asInt();
             units.append(u);
             p["unit_details"] = units;
@@ -467,35 +943,110 @@ void LandlordCtrl::approveRequest(const drogon::HttpRequestPtr &req,
         Json::Value u(Json::objectValue);
         u["unit_number"] = reqCopy["unit_number"].asString();
         u["bedrooms"] = reqCopy["unit_bedrooms"].asInt();
-        u["bathrooms"] = reqCopy["unit_bathrooms"].asInt();
+        u["bathrooms"] = reqCopy["unit_bathrooms"].asDouble();
         u["rent"] = reqCopy["unit_rent"].asInt();
         units.append(u);
         p["unit_details"] = units;
         props.append(p);
     }
 
-    // Insert landlord into Supabase
-    if(!SupabaseHelper::insertLandlord(landlordId, reqCopy["landlord_name"].asString(),
-                                       reqCopy["landlord_email"].asString(),
-                                       reqCopy["landlord_phone"].asString(),
-                                       props, err)) {
-        LOG_ERROR << "Failed to insert landlord: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to create landlord: " + err;
-        cb(resp);
-        return;
-    }
+    return props;
+}
 
-    // Delete the request
-    if(!SupabaseHelper::deleteLandlordRequest(requestId, err)) {
-        LOG_ERROR << "Failed to delete request: " << err;
-        // Continue anyway - landlord was created
-    }
+void LandlordCtrl::approveRequest(const drogon::HttpRequestPtr &req,
+                                  std::function<void (const drogon::HttpResponsePtr &)> &&cb,
+                                  int requestId)
+{
+    // Get request from Supabase
+    SupabaseHelper::getAllLandlordRequests([cb = std::move(cb), requestId](bool ok, const Json::Value &requestsArray, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to get landlord requests: " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "Failed to load requests: " + err;
+            cb(resp);
+            return;
+        }
 
-    Json::Value body(Json::objectValue);
-    body["ok"] = true;
-    body["id"] = requestId;
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
-    cb(resp);
-}
+        Json::Value reqCopy;
+        bool found = false;
+        for(const auto &r : requestsArray) {
+            if(r["id"].asInt() == requestId) {
+                reqCopy = r;
+                found = true;
+                break;
+            }
+        }
+
+        if(!found) {
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k404NotFound);
+            (*resp->getJsonObject())["error"] = "Request not found";
+            cb(resp);
+            return;
+        }
+
+        // Get all landlords to find max ID
+        SupabaseHelper::getAllLandlords([cb, requestId, reqCopy](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+            if(!ok) {
+                LOG_ERROR << "Failed to get landlords: " << err;
+                auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                resp->setStatusCode(drogon::k500InternalServerError);
+                (*resp->getJsonObject())["error"] = "Failed to load landlords: " + err;
+                cb(resp);
+                return;
+            }
+
+            // Generate new landlord ID
+            int maxId = 0;
+            for(const auto &ll : catalog->landlords) {
+                const std::string &idStr = ll.landlordId;
+                if(idStr.rfind("LL", 0) == 0 && idStr.length() >= 3) {
+                    try {
+                        int num = std::stoi(idStr.substr(2));
+                        if(num > maxId) maxId = num;
+                    } catch(const std::exception &e) {
+                        // Skip invalid IDs
+                        continue;
+                    }
+                }
+            }
+            int newId = maxId + 1;
+            char buf[16];
+            snprintf(buf, sizeof(buf), "LL%03d", newId);
+            std::string landlordId = buf;
+
+            // Build properties array from request
+            Json::Value props = buildPropertiesFromRequest(reqCopy, newId);
+
+            // Insert landlord into Supabase
+            SupabaseHelper::insertLandlord(landlordId, reqCopy["landlord_name"].asString(),
+                                           reqCopy["landlord_email"].asString(),
+                                           reqCopy["landlord_phone"].asString(),
+                                           props, [cb, requestId](bool ok, const std::string &err) {
+                if(!ok) {
+                    LOG_ERROR << "Failed to insert landlord: " << err;
+                    auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+                    resp->setStatusCode(drogon::k500InternalServerError);
+                    (*resp->getJsonObject())["error"] = "Failed to create landlord: " + err;
+                    cb(resp);
+                    return;
+                }
+
+                // Delete the request
+                SupabaseHelper::deleteLandlordRequest(requestId, [cb, requestId](bool ok, const std::string &err) {
+                    if(!ok) {
+                        LOG_ERROR << "Failed to delete request: " << err;
+                        // Continue anyway - landlord was created
+                    }
+
+                    Json::Value body(Json::objectValue);
+                    body["ok"] = true;
+                    body["id"] = requestId;
+                    auto resp = drogon::HttpResponse::newHttpJsonResponse(body);
+                    cb(resp);
+                });
+            });
+        });
+    });
+}
\ No newline at end of file
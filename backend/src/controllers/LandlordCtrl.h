@@ -1,7 +1,14 @@
 #pragma once
 #include <drogon/drogon.h>
 #include <json/json.h>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <vector>
+
+class Catalog;
+class SuggestIndex;
 
 /*  
     What is LandlordCtrl? 
@@ -18,6 +25,15 @@ public:
                std::function<void (const drogon::HttpResponsePtr &)> &&cb);
     void leaderboard(const drogon::HttpRequestPtr &req,
                     std::function<void (const drogon::HttpResponsePtr &)> &&cb);
+    void suggest(const drogon::HttpRequestPtr &req,
+                 std::function<void (const drogon::HttpResponsePtr &)> &&cb);
+    void detail(const drogon::HttpRequestPtr &req,
+                std::function<void (const drogon::HttpResponsePtr &)> &&cb,
+                const std::string &landlordId);
+    void searchProperties(const drogon::HttpRequestPtr &req,
+                          std::function<void (const drogon::HttpResponsePtr &)> &&cb);
+    void propertyStats(const drogon::HttpRequestPtr &req,
+                       std::function<void (const drogon::HttpResponsePtr &)> &&cb);
     void submitRequest(const drogon::HttpRequestPtr &req,
                        std::function<void (const drogon::HttpResponsePtr &)> &&cb);
     void listRequests(const drogon::HttpRequestPtr &req,
@@ -33,4 +49,22 @@ private:
     std::string dbPath_;
     std::string requestDbPath_;
     std::mutex mu_;
+
+    // Type-ahead index together with the catalog snapshot its positions point into
+    struct Suggestions {
+        std::shared_ptr<const Catalog> catalog;
+        std::shared_ptr<const SuggestIndex> index;
+        uint64_t version = 0;
+        std::chrono::steady_clock::time_point builtAt;
+    };
+    using SuggestionsCallback = std::function<void (const std::shared_ptr<const Suggestions> &)>;
+
+    // Hands done the current index, and rebuilds it in the background when the snapshot or
+    // the ratings have changed. Only the very first request waits for a build, and gets
+    // null if that build fails.
+    void withSuggestions(const std::shared_ptr<const Catalog> &catalog, SuggestionsCallback done);
+    void rebuildSuggestions(const std::shared_ptr<const Catalog> &catalog);
+    std::shared_ptr<const Suggestions> suggestions_;
+    std::vector<SuggestionsCallback> suggestWaiters_;
+    bool suggestRebuilding_ = false;
 };
@@ -0,0 +1,109 @@
+#include "NameIndex.h"
+#include "NameScan.h"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <utility>
+
+namespace {
+    uint32_t trigramAt(std::string_view text, size_t i) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16
+             | static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8
+             | static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2]));
+    }
+}
+
+std::string NameIndex::fold(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    return text;
+}
+
+std::string_view NameIndex::folded(uint32_t i) const {
+    return std::string_view(arena_.data() + offsets_[i], offsets_[i + 1] - offsets_[i] - 1);
+}
+
+void NameIndex::build(const std::vector<std::string> &names) {
+    size_t bytes = NAME_SCAN_PADDING;
+    for(const auto &name : names) bytes += name.size() + 1;
+    arena_.clear();
+    arena_.reserve(bytes);
+    offsets_.assign(1, 0);
+    for(const auto &name : names) {
+        size_t start = arena_.size();
+        arena_ += name;
+        std::transform(arena_.begin() + start, arena_.end(), arena_.begin() + start,
+                       [](unsigned char c){ return std::tolower(c); });
+        arena_ += '\0';
+        offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+    }
+    arena_.append(NAME_SCAN_PADDING, '\0');
+
+    // Every distinct (trigram, name) pair once, sorted by trigram then name
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for(uint32_t i = 0; i + 1 < offsets_.size(); i++) {
+        std::string_view name = folded(i);
+        for(size_t j = 0; j + 3 <= name.size(); j++) pairs.push_back({trigramAt(name, j), i});
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    trigrams_.clear();
+    first_.clear();
+    postings_.clear();
+    postings_.reserve(pairs.size());
+    for(const auto &pair : pairs) {
+        if(trigrams_.empty() || trigrams_.back() != pair.first) {
+            trigrams_.push_back(pair.first);
+            first_.push_back(static_cast<uint32_t>(postings_.size()));
+        }
+        postings_.push_back(pair.second);
+    }
+    first_.push_back(static_cast<uint32_t>(postings_.size()));
+}
+
+std::vector<uint32_t> NameIndex::scan(const std::string &query) const {
+    uint32_t count = static_cast<uint32_t>(offsets_.size() - 1);
+    std::vector<uint32_t> matches(count);
+    matches.resize(scanNames(arena_.data(), offsets_.data(), count, query, matches.data()));
+    return matches;
+}
+
+std::vector<uint32_t> NameIndex::find(const std::string &text) const {
+    std::string query = fold(text);
+    if(query.size() < 3) return scan(query);
+
+    // Posting list range of each distinct trigram of the query; a trigram no name has means
+    // no name can match
+    std::vector<std::pair<uint32_t, uint32_t>> lists;
+    for(size_t j = 0; j + 3 <= query.size(); j++) {
+        uint32_t trigram = trigramAt(query, j);
+        auto it = std::lower_bound(trigrams_.begin(), trigrams_.end(), trigram);
+        if(it == trigrams_.end() || *it != trigram) return {};
+        size_t t = it - trigrams_.begin();
+        lists.push_back({first_[t], first_[t + 1]});
+    }
+    std::sort(lists.begin(), lists.end());
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+    std::sort(lists.begin(), lists.end(), [](const auto &a, const auto &b) {
+        return a.second - a.first < b.second - b.first;
+    });
+
+    // Intersect starting from the shortest list, so the candidate set only shrinks
+    std::vector<uint32_t> candidates(postings_.begin() + lists[0].first, postings_.begin() + lists[0].second);
+    std::vector<uint32_t> kept;
+    for(size_t l = 1; l < lists.size() && !candidates.empty(); l++) {
+        kept.clear();
+        std::set_intersection(candidates.begin(), candidates.end(),
+                              postings_.begin() + lists[l].first, postings_.begin() + lists[l].second,
+                              std::back_inserter(kept));
+        candidates.swap(kept);
+    }
+
+    // Sharing every trigram does not make the query a substring, so check each candidate
+    std::vector<uint32_t> matches;
+    for(uint32_t i : candidates) {
+        if(folded(i).find(query) != std::string_view::npos) matches.push_back(i);
+    }
+    return matches;
+}
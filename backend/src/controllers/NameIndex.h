@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    What is the NameIndex?
+    A trigram inverted index over case-folded landlord names, built with each catalog
+    snapshot. Every 3-byte window of a folded name is a trigram, and each trigram has a
+    sorted posting list of the landlords whose names contain it. A substring query
+    intersects the lists of its own trigrams, starting with the shortest, then checks the few
+    candidates left. Queries shorter than a trigram scan every name instead.
+
+    The folded names themselves sit back to back in one arena, so the scan and the
+    candidate checks read contiguous memory and never copy a name.
+*/
+class NameIndex {
+public:
+    // ASCII case folding, the same folding search has always applied
+    static std::string fold(std::string text);
+
+    // Index names; names[i] is found as position i
+    void build(const std::vector<std::string> &names);
+
+    // Positions of the names that contain query as a case-insensitive substring, in
+    // ascending order. An empty query matches every name
+    std::vector<uint32_t> find(const std::string &query) const;
+
+private:
+    std::vector<uint32_t> scan(const std::string &query) const;
+    std::string_view folded(uint32_t i) const;
+
+    // Folded name i is arena_[offsets_[i], offsets_[i + 1] - 1), followed by a '\0'; the
+    // arena ends with NAME_SCAN_PADDING zero bytes for the scan kernel
+    std::string arena_;
+    std::vector<uint32_t> offsets_ = std::vector<uint32_t>(1, 0);
+    // Posting lists in compressed sparse row form: the names containing trigrams_[t] are
+    // postings_[first_[t], first_[t + 1]), with trigrams_ sorted for binary search
+    std::vector<uint32_t> trigrams_;
+    std::vector<uint32_t> first_;
+    std::vector<uint32_t> postings_;
+};
@@ -0,0 +1,147 @@
+#include "NameScan.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NAME_SCAN_SIMD 1
+#endif
+
+namespace {
+    size_t scanScalar(const char *arena, const uint32_t *offsets, uint32_t count,
+                      const std::string &needle, uint32_t *matches) {
+        size_t found = 0;
+        for(uint32_t i = 0; i < count; i++) {
+            const char *begin = arena + offsets[i];
+            const char *end = arena + offsets[i + 1] - 1;
+            for(const char *p = begin; p + needle.size() <= end; p++) {
+                if(std::memcmp(p, needle.data(), needle.size()) == 0) {
+                    matches[found++] = i;
+                    break;
+                }
+            }
+        }
+        return found;
+    }
+
+#ifdef NAME_SCAN_SIMD
+    __attribute__((target("avx2,bmi")))
+    size_t scanAvx2(const char *arena, const uint32_t *offsets, uint32_t count,
+                    const std::string &needle, uint32_t *matches) {
+        const size_t length = needle.size();
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[length - 1]);
+        const size_t arenaEnd = offsets[count];
+
+        size_t found = 0;
+        uint32_t name = 0;
+        size_t position = 0;
+        while(position < arenaEnd) {
+            __m256i atFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(arena + position));
+            __m256i atLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(arena + position + length - 1));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(atFirst, first), _mm256_cmpeq_epi8(atLast, last))));
+
+            size_t next = position + 32;
+            while(mask != 0) {
+                size_t candidate = position + _tzcnt_u32(mask);
+                mask &= mask - 1;
+                if(candidate >= arenaEnd) break;
+                if(length > 2 && std::memcmp(arena + candidate + 1, needle.data() + 1, length - 2) != 0) continue;
+
+                // The needle has no '\0', so a match never crosses a separator and lies in
+                // the string that holds its first byte
+                while(offsets[name + 1] <= candidate) name++;
+                matches[found++] = name;
+
+                // One match per string: carry on from the start of the next one
+                next = offsets[name + 1];
+                break;
+            }
+            position = next;
+        }
+        return found;
+    }
+
+    // PCMPESTRI in equal-ordered mode gives the first position in a 16-byte block where the
+    // needle's first (up to) 16 bytes occur, counting a match that runs off the end of the
+    // block, so every step either rules out 16 positions or lands on a candidate
+    __attribute__((target("sse4.2")))
+    size_t scanSse42(const char *arena, const uint32_t *offsets, uint32_t count,
+                     const std::string &needle, uint32_t *matches) {
+        const size_t length = needle.size();
+        const int prefixLength = static_cast<int>(std::min<size_t>(length, 16));
+        alignas(16) char prefixBytes[16] = {};
+        std::memcpy(prefixBytes, needle.data(), prefixLength);
+        const __m128i prefix = _mm_load_si128(reinterpret_cast<const __m128i *>(prefixBytes));
+        const size_t arenaEnd = offsets[count];
+
+        size_t found = 0;
+        uint32_t name = 0;
+        size_t position = 0;
+        while(position < arenaEnd) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(arena + position));
+            int index = _mm_cmpestri(prefix, prefixLength, block, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ORDERED);
+            if(index == 16) {
+                position += 16;
+                continue;
+            }
+            size_t candidate = position + index;
+            if(candidate >= arenaEnd) break;
+            while(offsets[name + 1] <= candidate) name++;
+
+            // The whole needle has to fit before the string's separator
+            if(candidate + length < offsets[name + 1]
+               && std::memcmp(arena + candidate, needle.data(), length) == 0) {
+                matches[found++] = name;
+                position = offsets[name + 1];
+            } else {
+                position = candidate + 1;
+            }
+        }
+        return found;
+    }
+
+    bool haveAvx2() {
+        static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+        return supported;
+    }
+
+    bool haveSse42() {
+        static const bool supported = __builtin_cpu_supports("sse4.2");
+        return supported;
+    }
+#endif
+}
+
+NameScanKernel bestNameScanKernel() {
+#ifdef NAME_SCAN_SIMD
+    if(haveAvx2()) return NameScanKernel::Avx2;
+    if(haveSse42()) return NameScanKernel::Sse42;
+#endif
+    return NameScanKernel::Scalar;
+}
+
+size_t scanNamesWith(NameScanKernel kernel, const char *arena, const uint32_t *offsets, uint32_t count,
+                     const std::string &needle, uint32_t *matches) {
+    if(needle.find('\0') != std::string::npos) return 0;
+    if(needle.empty()) {
+        for(uint32_t i = 0; i < count; i++) matches[i] = i;
+        return count;
+    }
+#ifdef NAME_SCAN_SIMD
+    // The padding has to cover the bytes read past the last position a needle could start
+    if(kernel == NameScanKernel::Avx2 && haveAvx2() && needle.size() <= NAME_SCAN_PADDING - 32) {
+        return scanAvx2(arena, offsets, count, needle, matches);
+    }
+    if(kernel != NameScanKernel::Scalar && haveSse42()) return scanSse42(arena, offsets, count, needle, matches);
+#else
+    (void)kernel;
+#endif
+    return scanScalar(arena, offsets, count, needle, matches);
+}
+
+size_t scanNames(const char *arena, const uint32_t *offsets, uint32_t count,
+                 const std::string &needle, uint32_t *matches) {
+    return scanNamesWith(bestNameScanKernel(), arena, offsets, count, needle, matches);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+    What is the name scan?
+    Substring search over many short strings laid out back to back in one arena: string i
+    is arena[offsets[i], offsets[i + 1] - 1), and the byte at offsets[i + 1] - 1 is a '\0'
+    separator. The arena must be followed by at least NAME_SCAN_PADDING readable bytes so
+    wide loads never run past its end.
+
+    On x86 CPUs with AVX2 the scan compares the needle's first and last bytes at 32 arena
+    positions at once and only checks the rest of the needle where both agree. CPUs with
+    SSE4.2 but not AVX2, and needles too long for the AVX2 loop's padding, use PCMPESTRI to
+    find the needle's first 16 bytes 16 positions at a time; other CPUs use a scalar loop.
+    None of them allocates.
+*/
+
+const size_t NAME_SCAN_PADDING = 64;
+
+// Write to matches, in ascending order, the index of every string containing needle and
+// return how many there are. matches must have room for count entries. A needle
+// containing '\0' matches nothing; an empty one matches every string
+size_t scanNames(const char *arena, const uint32_t *offsets, uint32_t count,
+                 const std::string &needle, uint32_t *matches);
+
+enum class NameScanKernel { Scalar, Sse42, Avx2 };
+
+// The fastest kernel this CPU supports
+NameScanKernel bestNameScanKernel();
+
+// scanNames using at most the given kernel: a kernel this CPU lacks, or one the needle
+// does not fit, falls back to the next slower one (for tests and benchmarks)
+size_t scanNamesWith(NameScanKernel kernel, const char *arena, const uint32_t *offsets, uint32_t count,
+                     const std::string &needle, uint32_t *matches);
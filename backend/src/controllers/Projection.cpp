@@ -0,0 +1,226 @@
+#include "Projection.h"
+#include "Catalog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+    // Field list -> plan. Field sets come from clients, so the cache starts over rather than
+    // growing without bound
+    const size_t PLAN_CACHE_LIMIT = 256;
+
+    std::mutex cacheMu;
+    std::map<std::string, std::shared_ptr<const Projection>> cache;
+
+    void writeNumber(std::string &out, double value) {
+        char buffer[32];
+        if(value == std::floor(value) && std::fabs(value) < 1e15) {
+            std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+        }
+        out += buffer;
+    }
+
+    // Appends ',' before every member but the first of an object or array
+    void separate(std::string &out, bool &first) {
+        if(!first) out += ',';
+        first = false;
+    }
+
+    void writeKey(std::string &out, bool &first, const char *key) {
+        separate(out, first);
+        out += '"';
+        out += key;
+        out += "\":";
+    }
+}
+
+std::shared_ptr<const Projection> Projection::compile(const std::string &fields, std::string &error) {
+    static const std::map<std::string, uint32_t> paths = {
+        {"landlord_id", LandlordId},
+        {"name", Name},
+        {"contact", CONTACT},
+        {"contact.email", Email},
+        {"contact.phone", Phone},
+        {"properties", PROPERTY},
+        {"properties.property_id", PropertyId},
+        {"properties.address", ADDRESS},
+        {"properties.address.street", Street},
+        {"properties.address.city", City},
+        {"properties.address.province", Province},
+        {"properties.address.zip", Zip},
+        {"properties.unit_details", UNIT},
+        {"properties.unit_details.unit_number", UnitNumber},
+        {"properties.unit_details.bedrooms", Bedrooms},
+        {"properties.unit_details.bathrooms", Bathrooms},
+        {"properties.unit_details.rent", Rent},
+        {"average_rating", AverageRating},
+        {"review_count", ReviewCount},
+        {"property_count", PropertyCount},
+        {"unit_count", UnitCount},
+        {"rank", Rank},
+        {"distance", Distance}
+    };
+
+    // Equal sets share one plan however they are spelled: "name,rank" and "rank,name,name"
+    std::vector<std::string> names;
+    std::stringstream in(fields);
+    std::string name;
+    while(std::getline(in, name, ',')) {
+        if(!name.empty()) names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    std::string key;
+    for(const auto &n : names) key += n + ',';
+
+    std::lock_guard<std::mutex> lk(cacheMu);
+    auto cached = cache.find(key);
+    if(cached != cache.end()) return cached->second;
+
+    uint32_t mask = 0;
+    for(const auto &n : names) {
+        auto path = paths.find(n);
+        if(path == paths.end()) {
+            error = "unknown field: " + n;
+            return nullptr;
+        }
+        mask |= path->second;
+    }
+    if(mask == 0) {
+        error = "fields must name at least one field";
+        return nullptr;
+    }
+
+    if(cache.size() >= PLAN_CACHE_LIMIT) cache.clear();
+    std::shared_ptr<const Projection> plan(new Projection(mask));
+    cache.emplace(key, plan);
+    return plan;
+}
+
+void Projection::writeString(std::string &out, const std::string &text) {
+    out += '"';
+    for(char c : text) {
+        switch(c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+                out += buffer;
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+void Projection::write(std::string &out, const Catalog &catalog, const Landlord &landlord, const LandlordFigures &figures) const {
+    // Members are written in a fixed order whatever order fields listed them in
+    bool first = true;
+    out += '{';
+    if(has(LandlordId)) {
+        writeKey(out, first, "landlord_id");
+        writeString(out, landlord.landlordId);
+    }
+    if(has(Name)) {
+        writeKey(out, first, "name");
+        writeString(out, landlord.name);
+    }
+    if(has(CONTACT)) {
+        writeKey(out, first, "contact");
+        bool firstContact = true;
+        out += '{';
+        if(has(Email)) {
+            writeKey(out, firstContact, "email");
+            writeString(out, landlord.email);
+        }
+        if(has(Phone)) {
+            writeKey(out, firstContact, "phone");
+            writeString(out, landlord.phone);
+        }
+        out += '}';
+    }
+
+    uint32_t propertiesEnd = landlord.firstProperty + landlord.propertyCount;
+    if(has(PROPERTY)) {
+        writeKey(out, first, "properties");
+        bool firstProperty = true;
+        out += '[';
+        for(uint32_t p = landlord.firstProperty; p < propertiesEnd; p++) {
+            const Property &property = catalog.properties[p];
+            separate(out, firstProperty);
+            bool firstMember = true;
+            out += '{';
+            if(has(PropertyId)) {
+                writeKey(out, firstMember, "property_id");
+                writeString(out, property.propertyId);
+            }
+            if(has(ADDRESS)) {
+                writeKey(out, firstMember, "address");
+                bool firstLine = true;
+                out += '{';
+                if(has(Street)) { writeKey(out, firstLine, "street"); writeString(out, property.street); }
+                if(has(City)) { writeKey(out, firstLine, "city"); writeString(out, property.city); }
+                if(has(Province)) { writeKey(out, firstLine, "province"); writeString(out, property.province); }
+                if(has(Zip)) { writeKey(out, firstLine, "zip"); writeString(out, property.zip); }
+                out += '}';
+            }
+            if(has(UNIT)) {
+                writeKey(out, firstMember, "unit_details");
+                bool firstUnit = true;
+                out += '[';
+                for(uint32_t u = property.firstUnit; u < property.firstUnit + property.unitCount; u++) {
+                    const Unit &unit = catalog.units[u];
+                    separate(out, firstUnit);
+                    bool firstValue = true;
+                    out += '{';
+                    if(has(UnitNumber)) { writeKey(out, firstValue, "unit_number"); writeString(out, unit.unitNumber); }
+                    if(has(Bedrooms)) { writeKey(out, firstValue, "bedrooms"); out += std::to_string(unit.bedrooms); }
+                    if(has(Bathrooms)) { writeKey(out, firstValue, "bathrooms"); writeNumber(out, unit.bathrooms); }
+                    if(has(Rent)) { writeKey(out, firstValue, "rent"); writeNumber(out, unit.rent); }
+                    out += '}';
+                }
+                out += ']';
+            }
+            out += '}';
+        }
+        out += ']';
+    }
+
+    if(has(AverageRating)) {
+        writeKey(out, first, "average_rating");
+        writeNumber(out, figures.averageRating);
+    }
+    if(has(ReviewCount)) {
+        writeKey(out, first, "review_count");
+        out += std::to_string(figures.reviewCount);
+    }
+    if(has(PropertyCount)) {
+        writeKey(out, first, "property_count");
+        out += std::to_string(landlord.propertyCount);
+    }
+    if(has(UnitCount)) {
+        writeKey(out, first, "unit_count");
+        out += std::to_string(landlord.unitCount);
+    }
+    if(has(Rank) && figures.rank) {
+        writeKey(out, first, "rank");
+        out += std::to_string(*figures.rank);
+    }
+    if(has(Distance) && figures.distance) {
+        writeKey(out, first, "distance");
+        out += std::to_string(*figures.distance);
+    }
+    out += '}';
+}
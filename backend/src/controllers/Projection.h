@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+class Catalog;
+struct Landlord;
+
+// Values of a landlord entry that are not part of the catalog itself
+struct LandlordFigures {
+    double averageRating = 0;               // already rounded for display
+    uint32_t reviewCount = 0;
+    std::optional<uint64_t> rank;           // leaderboard only
+    std::optional<int> distance;            // fuzzy search only
+};
+
+/*
+    What is a Projection?
+    The plan for a fields= parameter: which paths of a landlord entry to emit, e.g.
+    "name,average_rating,properties.address.city". A plan is compiled once per distinct
+    field set and shared by every request that asks for the same set. Writing an entry
+    walks the catalog structs and appends only the planned members as JSON text, so the
+    full landlord object is never built and then thrown away.
+*/
+class Projection {
+public:
+    // The shared plan for a comma separated field list. Returns nullptr and sets error if
+    // a field is unknown
+    static std::shared_ptr<const Projection> compile(const std::string &fields, std::string &error);
+
+    // Append one landlord entry as a JSON object
+    void write(std::string &out, const Catalog &catalog, const Landlord &landlord, const LandlordFigures &figures) const;
+
+    // Append text as a JSON string literal
+    static void writeString(std::string &out, const std::string &text);
+
+private:
+    // One bit per leaf path of a landlord entry
+    enum Field : uint32_t {
+        LandlordId = 1u << 0,
+        Name = 1u << 1,
+        Email = 1u << 2,
+        Phone = 1u << 3,
+        PropertyId = 1u << 4,
+        Street = 1u << 5,
+        City = 1u << 6,
+        Province = 1u << 7,
+        Zip = 1u << 8,
+        UnitNumber = 1u << 9,
+        Bedrooms = 1u << 10,
+        Bathrooms = 1u << 11,
+        Rent = 1u << 12,
+        AverageRating = 1u << 13,
+        ReviewCount = 1u << 14,
+        PropertyCount = 1u << 15,
+        UnitCount = 1u << 16,
+        Rank = 1u << 17,
+        Distance = 1u << 18
+    };
+
+    static constexpr uint32_t CONTACT = Email | Phone;
+    static constexpr uint32_t ADDRESS = Street | City | Province | Zip;
+    static constexpr uint32_t UNIT = UnitNumber | Bedrooms | Bathrooms | Rent;
+    static constexpr uint32_t PROPERTY = PropertyId | ADDRESS | UNIT;
+
+    explicit Projection(uint32_t fields) : fields_(fields) {}
+
+    bool has(uint32_t fields) const { return (fields_ & fields) != 0; }
+
+    uint32_t fields_;
+};
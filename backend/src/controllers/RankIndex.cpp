@@ -0,0 +1,140 @@
+#include "RankIndex.h"
+#include <algorithm>
+
+RankIndex::RankIndex() : rng_(0x5eed) {
+    head_.links.resize(MAX_LEVEL);
+}
+
+RankIndex::~RankIndex() {
+    clear();
+}
+
+void RankIndex::clear() {
+    Node *node = head_.links[0].next;
+    while(node) {
+        Node *next = node->links[0].next;
+        delete node;
+        node = next;
+    }
+    for(auto &link : head_.links) link = Link();
+    level_ = 1;
+    size_ = 0;
+}
+
+// True if node sorts before the entry (id, score): higher score first, then lower id
+bool RankIndex::before(const Node *node, uint32_t id, double score) {
+    if(node->score != score) return node->score > score;
+    return node->id < id;
+}
+
+int RankIndex::randomLevel() {
+    // Each level holds about a quarter of the nodes of the level below
+    int level = 1;
+    while(level < MAX_LEVEL && (rng_() & 3) == 0) level++;
+    return level;
+}
+
+void RankIndex::insert(uint32_t id, double score) {
+    Node *update[MAX_LEVEL];
+    size_t rankAt[MAX_LEVEL];
+    Node *node = &head_;
+    size_t position = 0;
+    for(int i = level_ - 1; i >= 0; i--) {
+        while(node->links[i].next && before(node->links[i].next, id, score)) {
+            position += node->links[i].width;
+            node = node->links[i].next;
+        }
+        update[i] = node;
+        rankAt[i] = position;
+    }
+
+    int level = randomLevel();
+    if(level > level_) {
+        for(int i = level_; i < level; i++) {
+            update[i] = &head_;
+            rankAt[i] = 0;
+            head_.links[i].width = size_ + 1;
+        }
+        level_ = level;
+    }
+
+    Node *created = new Node;
+    created->id = id;
+    created->score = score;
+    created->links.resize(level);
+    size_t newPosition = rankAt[0] + 1;
+    for(int i = 0; i < level; i++) {
+        Link &link = update[i]->links[i];
+        created->links[i].next = link.next;
+        created->links[i].width = link.width + rankAt[i] + 1 - newPosition;
+        link.next = created;
+        link.width = newPosition - rankAt[i];
+    }
+    for(int i = level; i < level_; i++) {
+        update[i]->links[i].width++;
+    }
+    size_++;
+}
+
+bool RankIndex::erase(uint32_t id, double score) {
+    Node *update[MAX_LEVEL];
+    Node *node = &head_;
+    for(int i = level_ - 1; i >= 0; i--) {
+        while(node->links[i].next && before(node->links[i].next, id, score)) {
+            node = node->links[i].next;
+        }
+        update[i] = node;
+    }
+
+    Node *target = update[0]->links[0].next;
+    if(!target || target->id != id || target->score != score) return false;
+
+    for(int i = 0; i < level_; i++) {
+        Link &link = update[i]->links[i];
+        if(link.next == target) {
+            link.width += target->links[i].width - 1;
+            link.next = target->links[i].next;
+        } else {
+            link.width--;
+        }
+    }
+    delete target;
+    while(level_ > 1 && !head_.links[level_ - 1].next) level_--;
+    size_--;
+    return true;
+}
+
+long RankIndex::rank(uint32_t id, double score) const {
+    const Node *node = &head_;
+    size_t position = 0;
+    for(int i = level_ - 1; i >= 0; i--) {
+        while(node->links[i].next && before(node->links[i].next, id, score)) {
+            position += node->links[i].width;
+            node = node->links[i].next;
+        }
+    }
+    const Node *target = node->links[0].next;
+    if(!target || target->id != id || target->score != score) return -1;
+    return static_cast<long>(position);
+}
+
+std::vector<uint32_t> RankIndex::range(size_t offset, size_t limit) const {
+    std::vector<uint32_t> ids;
+    if(offset >= size_ || limit == 0) return ids;
+
+    // Walk down to the node at position offset (the head is position 0, entries start at 1)
+    const Node *node = &head_;
+    size_t position = 0;
+    for(int i = level_ - 1; i >= 0; i--) {
+        while(node->links[i].next && position + node->links[i].width <= offset) {
+            position += node->links[i].width;
+            node = node->links[i].next;
+        }
+    }
+
+    ids.reserve(std::min(limit, size_ - offset));
+    for(node = node->links[0].next; node && ids.size() < limit; node = node->links[0].next) {
+        ids.push_back(node->id);
+    }
+    return ids;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/*
+    What is a RankIndex?
+    An indexable skip list of (score, id) entries, ordered by score from highest to lowest
+    and then by id, where ids are interned keys (see IdInterner). Each forward link also
+    records how many entries it skips, so besides O(log n) insert and erase it can find the
+    entry at a given position and the position of a given entry in O(log n). That is what
+    leaderboard pages and rank lookups need.
+*/
+class RankIndex {
+public:
+    RankIndex();
+    ~RankIndex();
+    RankIndex(const RankIndex &) = delete;
+    RankIndex &operator=(const RankIndex &) = delete;
+
+    void insert(uint32_t id, double score);
+    // Returns false if there was no such entry
+    bool erase(uint32_t id, double score);
+    void clear();
+
+    size_t size() const { return size_; }
+
+    // 0-based position of the entry, or -1 if it is not in the index
+    long rank(uint32_t id, double score) const;
+
+    // Ids of up to limit entries starting at position offset
+    std::vector<uint32_t> range(size_t offset, size_t limit) const;
+
+private:
+    static const int MAX_LEVEL = 24;
+
+    struct Node;
+
+    struct Link {
+        Node *next = nullptr;
+        size_t width = 1;           // positions advanced by following next (to size() + 1 when next is null)
+    };
+
+    struct Node {
+        uint32_t id = 0;
+        double score = 0;
+        std::vector<Link> links;    // one per level the node appears on
+    };
+
+    static bool before(const Node *node, uint32_t id, double score);
+    int randomLevel();
+
+    Node head_;
+    int level_ = 1;                 // levels in use
+    size_t size_ = 0;
+    std::minstd_rand rng_;
+};
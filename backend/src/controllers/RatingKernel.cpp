@@ -0,0 +1,98 @@
+#include "RatingKernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RATING_KERNEL_AVX2 1
+#endif
+
+namespace {
+    // counts has one extra slot past the histograms that invalid reviews are sent to, so
+    // the loops never branch on validity
+    void countScalar(const uint32_t *landlordKeys, const uint8_t *ratings, size_t begin, size_t end,
+                     uint32_t keyCount, uint32_t *counts) {
+        const uint32_t sink = keyCount * 5;
+        for(size_t i = begin; i < end; i++) {
+            uint32_t key = landlordKeys[i];
+            uint32_t rating = ratings[i];
+            bool valid = key < keyCount && rating >= 1 && rating <= 5;
+            counts[valid ? key * 5 + rating - 1 : sink]++;
+        }
+    }
+
+#ifdef RATING_KERNEL_AVX2
+    // AVX2 has no scatter, so the slots are computed 8 at a time and the increments stay scalar
+    __attribute__((target("avx2")))
+    size_t countAvx2(const uint32_t *landlordKeys, const uint8_t *ratings, size_t count,
+                     uint32_t keyCount, uint32_t *counts) {
+        // Unsigned compares are done as signed ones on values with the top bit flipped
+        const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+        const __m256i keyLimit = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(keyCount)), bias);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i six = _mm256_set1_epi32(6);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i sink = _mm256_set1_epi32(static_cast<int>(keyCount * 5));
+        alignas(32) uint32_t slots[8];
+
+        size_t i = 0;
+        for(; i + 8 <= count; i += 8) {
+            __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(landlordKeys + i));
+            __m256i stars = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(ratings + i)));
+
+            __m256i keyOk = _mm256_cmpgt_epi32(keyLimit, _mm256_xor_si256(keys, bias));
+            __m256i starsOk = _mm256_and_si256(_mm256_cmpgt_epi32(stars, zero), _mm256_cmpgt_epi32(six, stars));
+            __m256i valid = _mm256_and_si256(keyOk, starsOk);
+
+            // key * 5 + rating - 1
+            __m256i slot = _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(keys, 2), keys), _mm256_sub_epi32(stars, one));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(slots), _mm256_blendv_epi8(sink, slot, valid));
+
+            counts[slots[0]]++;
+            counts[slots[1]]++;
+            counts[slots[2]]++;
+            counts[slots[3]]++;
+            counts[slots[4]]++;
+            counts[slots[5]]++;
+            counts[slots[6]]++;
+            counts[slots[7]]++;
+        }
+        return i;
+    }
+
+    bool haveAvx2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+#endif
+}
+
+namespace {
+    std::vector<uint32_t> countWith(const uint32_t *landlordKeys, const uint8_t *ratings, size_t count, uint32_t keyCount,
+                                    bool simd) {
+        std::vector<uint32_t> counts(static_cast<size_t>(keyCount) * 5 + 1, 0);
+        size_t done = 0;
+#ifdef RATING_KERNEL_AVX2
+        if(simd) done = countAvx2(landlordKeys, ratings, count, keyCount, counts.data());
+#else
+        (void)simd;
+#endif
+        countScalar(landlordKeys, ratings, done, count, keyCount, counts.data());
+        counts.pop_back();
+        return counts;
+    }
+}
+
+std::vector<uint32_t> countRatings(const uint32_t *landlordKeys, const uint8_t *ratings, size_t count, uint32_t keyCount) {
+    return countWith(landlordKeys, ratings, count, keyCount, ratingKernelUsesAvx2());
+}
+
+std::vector<uint32_t> countRatingsScalar(const uint32_t *landlordKeys, const uint8_t *ratings, size_t count, uint32_t keyCount) {
+    return countWith(landlordKeys, ratings, count, keyCount, false);
+}
+
+bool ratingKernelUsesAvx2() {
+#ifdef RATING_KERNEL_AVX2
+    return haveAvx2();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+    What is the rating kernel?
+    The single pass that turns review columns (landlord key, rating) into a 1-5 histogram per
+    landlord: histograms[key * 5 + rating - 1] counts the reviews of that key and rating.
+    Sums and counts follow from the histogram, so nothing else has to walk the reviews.
+    Reviews with a rating outside 1-5 or a key at or past keyCount are ignored.
+
+    On x86 CPUs with AVX2 the validation and slot arithmetic run 8 reviews at a time; other
+    CPUs use the scalar loop. Both give identical results.
+*/
+std::vector<uint32_t> countRatings(const uint32_t *landlordKeys, const uint8_t *ratings, size_t count, uint32_t keyCount);
+
+// The same count using the scalar loop only, whatever the CPU supports (for tests and benchmarks)
+std::vector<uint32_t> countRatingsScalar(const uint32_t *landlordKeys, const uint8_t *ratings, size_t count, uint32_t keyCount);
+
+// True if countRatings runs the AVX2 loop on this CPU
+bool ratingKernelUsesAvx2();
@@ -0,0 +1,221 @@
+#include "RatingStore.h"
+#include "SupabaseHelper.h"
+#include "Catalog.h"
+#include "IdInterner.h"
+#include "RatingKernel.h"
+#include <trantor/net/EventLoop.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <unordered_set>
+
+RatingStore &RatingStore::instance() {
+    static RatingStore store;
+    return store;
+}
+
+void RatingStore::start(trantor::EventLoop *loop, double intervalSeconds) {
+    reconcile();
+    loop->runEvery(intervalSeconds, [this]() { reconcile(); });
+}
+
+void RatingStore::whenReady(std::function<void ()> done) {
+    bool startLoad = false;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if(!loaded_) {
+            // Hand done back to the event loop of the request that is waiting
+            auto *loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+            if(loop) {
+                waiters_.push_back([loop, done = std::move(done)]() { loop->queueInLoop(done); });
+            } else {
+                waiters_.push_back(std::move(done));
+            }
+            startLoad = !reconciling_;
+            done = nullptr;
+        }
+    }
+    if(done) {
+        done();
+        return;
+    }
+    if(startLoad) reconcile();
+}
+
+LandlordRating RatingStore::get(const std::string &landlordId) const {
+    return get(IdInterner::landlords().find(landlordId));
+}
+
+LandlordRating RatingStore::get(uint32_t landlordKey) const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return ratingOf(landlordKey);
+}
+
+// Called with mu_ held
+LandlordRating RatingStore::ratingOf(uint32_t landlordKey) const {
+    return landlordKey < ratings_.size() ? ratings_[landlordKey] : LandlordRating();
+}
+
+void RatingStore::addReview(const std::string &reviewId, const std::string &landlordId, int rating) {
+    record(reviewId, landlordId, rating, true);
+}
+
+void RatingStore::removeReview(const std::string &reviewId, const std::string &landlordId, int rating) {
+    record(reviewId, landlordId, rating, false);
+}
+
+void RatingStore::record(const std::string &reviewId, const std::string &landlordId, int rating, bool added) {
+    if(rating < 1 || rating > 5) return;
+    uint32_t landlordKey = IdInterner::landlords().intern(landlordId);
+    std::lock_guard<std::mutex> lk(mu_);
+    bool isRanked = landlordKey < ranked_.size() && ranked_[landlordKey];
+    if(isRanked) unrankLandlord(landlordKey);
+    apply(ratings_, landlordKey, rating, added);
+    version_++;
+    if(isRanked) rankLandlord(landlordKey);
+    if(reconciling_) pending_.push_back({reviewId, landlordKey, rating, added});
+}
+
+void RatingStore::apply(std::vector<LandlordRating> &ratings, uint32_t landlordKey, int rating, bool added) {
+    if(landlordKey >= ratings.size()) ratings.resize(landlordKey + 1);
+    LandlordRating &r = ratings[landlordKey];
+    if(added) {
+        r.sum += rating;
+        r.count++;
+        r.histogram[rating - 1]++;
+    } else if(r.count > 0 && r.histogram[rating - 1] > 0) {
+        r.sum -= rating;
+        r.count--;
+        r.histogram[rating - 1]--;
+    }
+}
+
+void RatingStore::reconcile() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if(reconciling_) return;
+        reconciling_ = true;
+        pending_.clear();
+    }
+
+    SupabaseHelper::getAllReviews([this](bool ok, const std::shared_ptr<const ReviewSet> &reviews, const std::string &err) {
+        std::vector<std::function<void ()>> waiters;
+        if(!ok) {
+            LOG_ERROR << "Failed to load reviews for rating aggregates: " << err;
+            std::lock_guard<std::mutex> lk(mu_);
+            reconciling_ = false;
+            pending_.clear();
+            waiters.swap(waiters_);
+        } else {
+            // One pass over the review columns gives every landlord's histogram; sums and
+            // counts are derived from it
+            uint32_t keyCount = IdInterner::landlords().size();
+            std::vector<uint32_t> histograms = countRatings(reviews->landlordKeys.data(), reviews->ratings.data(),
+                                                            reviews->size(), keyCount);
+            std::vector<LandlordRating> ratings(keyCount);
+            for(uint32_t key = 0; key < keyCount; key++) {
+                LandlordRating &r = ratings[key];
+                for(int star = 1; star <= 5; star++) {
+                    uint32_t n = histograms[key * 5 + star - 1];
+                    r.histogram[star - 1] = n;
+                    r.count += n;
+                    r.sum += static_cast<uint64_t>(n) * star;
+                }
+            }
+
+            std::lock_guard<std::mutex> lk(mu_);
+            // Replay reviews submitted or removed while the reload was in flight, unless the
+            // reloaded data already reflects them
+            if(!pending_.empty()) {
+                std::unordered_set<std::string> pendingIds;
+                for(const auto &delta : pending_) pendingIds.insert(delta.reviewId);
+                std::unordered_set<std::string> reloaded;
+                for(const auto &id : reviews->reviewIds) {
+                    if(pendingIds.count(id)) reloaded.insert(id);
+                }
+                for(const auto &delta : pending_) {
+                    bool present = reloaded.count(delta.reviewId) > 0;
+                    if(delta.added != present) apply(ratings, delta.landlordKey, delta.rating, delta.added);
+                }
+            }
+            ratings_.swap(ratings);
+            rebuildRankings();
+            loaded_ = true;
+            version_++;
+            reconciling_ = false;
+            pending_.clear();
+            waiters.swap(waiters_);
+        }
+        for(auto &waiter : waiters) waiter();
+    });
+}
+
+void RatingStore::rankLandlord(uint32_t landlordKey) {
+    LandlordRating rating = ratingOf(landlordKey);
+    byRating_.insert(landlordKey, rating.average());
+    byReviews_.insert(landlordKey, rating.count);
+}
+
+void RatingStore::unrankLandlord(uint32_t landlordKey) {
+    LandlordRating rating = ratingOf(landlordKey);
+    byRating_.erase(landlordKey, rating.average());
+    byReviews_.erase(landlordKey, rating.count);
+}
+
+// Re-key every ranked landlord after the aggregates were replaced; called with mu_ held
+void RatingStore::rebuildRankings() {
+    byRating_.clear();
+    byReviews_.clear();
+    for(uint32_t key = 0; key < ranked_.size(); key++) {
+        if(ranked_[key]) rankLandlord(key);
+    }
+}
+
+void RatingStore::syncLandlords(const std::shared_ptr<const Catalog> &catalog) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if(rankedCatalog_.lock() == catalog) return;
+
+    std::vector<bool> current(std::max<size_t>(ranked_.size(), IdInterner::landlords().size()), false);
+    for(const auto &landlord : catalog->landlords) current[landlord.key] = true;
+    ranked_.resize(current.size(), false);
+
+    // Only landlords that were added or removed since the last snapshot move
+    for(uint32_t key = 0; key < current.size(); key++) {
+        if(current[key] == ranked_[key]) continue;
+        if(current[key]) {
+            rankLandlord(key);
+            rankedCount_++;
+        } else {
+            unrankLandlord(key);
+            rankedCount_--;
+        }
+    }
+    ranked_.swap(current);
+    rankedCatalog_ = catalog;
+}
+
+const RankIndex &RatingStore::ranking(RankOrder order) const {
+    return order == RankOrder::Reviews ? byReviews_ : byRating_;
+}
+
+std::vector<uint32_t> RatingStore::ranked(RankOrder order, size_t offset, size_t limit) const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return ranking(order).range(offset, limit);
+}
+
+long RatingStore::rankOf(RankOrder order, uint32_t landlordKey) const {
+    std::lock_guard<std::mutex> lk(mu_);
+    if(landlordKey >= ranked_.size() || !ranked_[landlordKey]) return -1;
+    LandlordRating rating = ratingOf(landlordKey);
+    double score = order == RankOrder::Reviews ? rating.count : rating.average();
+    return ranking(order).rank(landlordKey, score);
+}
+
+size_t RatingStore::rankedCount() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return rankedCount_;
+}
+
+uint64_t RatingStore::version() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return version_;
+}
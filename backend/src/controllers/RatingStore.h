@@ -0,0 +1,113 @@
+#pragma once
+#include "RankIndex.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trantor {
+    class EventLoop;
+}
+
+class Catalog;
+
+/*
+    What is the RatingStore?
+    Per-landlord rating aggregates (sum, count and a 1-5 histogram) kept in memory for the
+    life of the server. They are loaded from Supabase once, then kept current by applying
+    each review that is submitted or removed, so search and leaderboard never download all
+    reviews on the request path. A periodic reconciliation reloads everything from Supabase
+    to pick up changes made outside this server. Aggregates are a flat array indexed by
+    the landlord's interned key (IdInterner::landlords()).
+
+    The store also keeps the catalog's landlords ranked by average rating and by review
+    count. A rating change moves one entry in each ranking, so leaderboard pages and rank
+    lookups never sort the whole list.
+*/
+
+struct LandlordRating {
+    uint64_t sum = 0;
+    uint32_t count = 0;
+    uint32_t histogram[5] = {0, 0, 0, 0, 0};   // histogram[r - 1] is the number of r-star reviews
+
+    double average() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+};
+
+enum class RankOrder {
+    Rating,     // highest average rating first
+    Reviews     // most reviews first
+};
+
+class RatingStore {
+public:
+    static RatingStore &instance();
+
+    // Load the ratings now and reconcile them on loop every intervalSeconds
+    void start(trantor::EventLoop *loop, double intervalSeconds);
+
+    // Run done once ratings are available (at once if they are loaded already). If the
+    // first load fails, done still runs and every landlord reads as unrated
+    void whenReady(std::function<void ()> done);
+
+    // Aggregates of one landlord (all zero if it has no reviews)
+    LandlordRating get(const std::string &landlordId) const;
+    LandlordRating get(uint32_t landlordKey) const;
+
+    // Apply a review that was stored or deleted in Supabase
+    void addReview(const std::string &reviewId, const std::string &landlordId, int rating);
+    void removeReview(const std::string &reviewId, const std::string &landlordId, int rating);
+
+    // Reload every review from Supabase and replace the aggregates
+    void reconcile();
+
+    // Rank exactly the landlords of this catalog snapshot. Cheap when it is already synced
+    void syncLandlords(const std::shared_ptr<const Catalog> &catalog);
+
+    // Landlord keys at positions [offset, offset + limit) of a ranking
+    std::vector<uint32_t> ranked(RankOrder order, size_t offset, size_t limit) const;
+
+    // 0-based position of a landlord in a ranking, or -1 if it is not ranked
+    long rankOf(RankOrder order, uint32_t landlordKey) const;
+
+    size_t rankedCount() const;
+
+    // Changes every time any aggregate changes, so derived data can tell it is out of date
+    uint64_t version() const;
+
+private:
+    RatingStore() = default;
+
+    struct Delta {
+        std::string reviewId;
+        uint32_t landlordKey;
+        int rating;
+        bool added;
+    };
+
+    void apply(std::vector<LandlordRating> &ratings, uint32_t landlordKey, int rating, bool added);
+    void record(const std::string &reviewId, const std::string &landlordId, int rating, bool added);
+    LandlordRating ratingOf(uint32_t landlordKey) const;
+    void rankLandlord(uint32_t landlordKey);
+    void unrankLandlord(uint32_t landlordKey);
+    void rebuildRankings();
+    const RankIndex &ranking(RankOrder order) const;
+
+    mutable std::mutex mu_;
+    std::vector<LandlordRating> ratings_;      // by landlord key; keys past the end have no reviews
+    bool loaded_ = false;
+    uint64_t version_ = 0;
+    bool reconciling_ = false;
+    // Reviews applied while a reconciliation is in flight; replayed onto its result when
+    // the reloaded data does not reflect them yet
+    std::vector<Delta> pending_;
+    std::vector<std::function<void ()>> waiters_;
+
+    // Rankings of the landlords in ranked_, keyed by their current aggregates
+    RankIndex byRating_;
+    RankIndex byReviews_;
+    std::vector<bool> ranked_;                  // by landlord key
+    size_t rankedCount_ = 0;
+    std::weak_ptr<const Catalog> rankedCatalog_;
+};
@@ -1,5 +1,6 @@
 #include "ReviewCtrl.h"
 #include "SupabaseHelper.h"
+#include "RatingStore.h"
 #include <fstream>
 #include <chrono>
 #include <random>
@@ -74,63 +75,68 @@ void ReviewCtrl::submit(const drogon::HttpRequestPtr &req,
     review["created_at"] = timeStr;
 
     // Insert to Supabase database (retry with new ID if collision)
-    std::string supabaseErr;
-    bool inserted = false;
-    for(int retry = 0; retry < 3 && !inserted; retry++) {
-        if(SupabaseHelper::insertReview(review["id"].asString(),
-                                        review["landlord_id"].asString(),
-                                        review["rating"].asInt(),
-                                        review["title"].asString(),
-                                        review["review"].asString(),
-                                        review["created_at"].asString(),
-                                        supabaseErr)) {
-            inserted = true;
-        } else if(supabaseErr.find("duplicate key") != std::string::npos || 
-                  supabaseErr.find("23505") != std::string::npos) {
+    insertWithRetry(std::make_shared<Json::Value>(review), 0, std::move(callback));
+}
+
+void ReviewCtrl::insertWithRetry(std::shared_ptr<Json::Value> review, int retry,
+                                 std::function<void (const drogon::HttpResponsePtr &)> &&callback) {
+    const Json::Value &r = *review;
+    SupabaseHelper::insertReview(r["id"].asString(),
+                                 r["landlord_id"].asString(),
+                                 r["rating"].asInt(),
+                                 r["title"].asString(),
+                                 r["review"].asString(),
+                                 r["created_at"].asString(),
+                                 [review, retry, callback = std::move(callback)](bool inserted, const std::string &supabaseErr) mutable {
+        if(!inserted && retry + 1 < 3 &&
+           (supabaseErr.find("duplicate key") != std::string::npos ||
+            supabaseErr.find("23505") != std::string::npos)) {
             // ID collision - generate new ID
             auto now = std::chrono::system_clock::now();
             auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-            review["id"] = std::to_string(now_ms % 90000 + 10000);
-        } else {
-            // Other error - break and return error
-            break;
+            (*review)["id"] = std::to_string(now_ms % 90000 + 10000);
+            insertWithRetry(review, retry + 1, std::move(callback));
+            return;
         }
-    }
-    
-    if(!inserted) {
-        LOG_ERROR << "Supabase review insert failed: " << supabaseErr;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "failed to save review to database: " + supabaseErr;
-        callback(resp);
-        return;
-    }
 
-    // Return success response
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(review);
-    callback(resp);
+        if(!inserted) {
+            LOG_ERROR << "Supabase review insert failed: " << supabaseErr;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "failed to save review to database: " + supabaseErr;
+            callback(resp);
+            return;
+        }
+
+        const Json::Value &stored = *review;
+        RatingStore::instance().addReview(stored["id"].asString(), stored["landlord_id"].asString(), stored["rating"].asInt());
+
+        // Return success response
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(*review);
+        callback(resp);
+    });
 }
 
 void ReviewCtrl::getForLandlord(const drogon::HttpRequestPtr &req,
                                std::function<void (const drogon::HttpResponsePtr &)> &&callback,
                                const std::string &landlordId) {
     // Get reviews from Supabase database
-    Json::Value reviewsArray;
-    std::string err;
-    if(!SupabaseHelper::getReviewsForLandlord(landlordId, reviewsArray, err)) {
-        LOG_ERROR << "Failed to get reviews for landlord " << landlordId << ": " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "failed to load reviews";
-        callback(resp);
-        return;
-    }
+    SupabaseHelper::getReviewsForLandlord(landlordId, [callback = std::move(callback), landlordId](bool ok, const Json::Value &reviewsArray, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to get reviews for landlord " << landlordId << ": " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "failed to load reviews";
+            callback(resp);
+            return;
+        }
 
-    // Return reviews
-    Json::Value response(Json::objectValue);
-    response["reviews"] = reviewsArray;
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
-    callback(resp);
+        // Return reviews
+        Json::Value response(Json::objectValue);
+        response["reviews"] = reviewsArray;
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(response);
+        callback(resp);
+    });
 }
 
 void ReviewCtrl::submitReport(const drogon::HttpRequestPtr &req,
@@ -165,24 +171,6 @@ void ReviewCtrl::submitReport(const drogon::HttpRequestPtr &req,
     char timeStr[100];
     std::strftime(timeStr, sizeof(timeStr), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now_c));
 
-    // Insert into Supabase
-    std::string err;
-    if(!SupabaseHelper::insertReportedReview(reportId,
-                                             (*json)["review_id"].asString(),
-                                             (*json)["title"].asString(),
-                                             (*json)["review"].asString(),
-                                             (*json)["reason"].asString(),
-                                             (*json).get("reported_by", Json::Value("anonymous")).asString(),
-                                             timeStr,
-                                             err)) {
-        LOG_ERROR << "Failed to insert reported review: " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "Failed to save report: " + err;
-        callback(resp);
-        return;
-    }
-
     Json::Value rep(Json::objectValue);
     rep["id"] = reportId;
     rep["review_id"] = (*json)["review_id"];
@@ -193,6 +181,25 @@ void ReviewCtrl::submitReport(const drogon::HttpRequestPtr &req,
     rep["created_at"] = timeStr;
     rep["status"] = "pending";
 
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(rep);
-    callback(resp);
-}
\ No newline at end of file
+    // Insert into Supabase
+    SupabaseHelper::insertReportedReview(reportId,
+                                         rep["review_id"].asString(),
+                                         rep["title"].asString(),
+                                         rep["review"].asString(),
+                                         rep["reason"].asString(),
+                                         rep["reported_by"].asString(),
+                                         timeStr,
+                                         [callback = std::move(callback), rep](bool ok, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to insert reported review: " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "Failed to save report: " + err;
+            callback(resp);
+            return;
+        }
+
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(rep);
+        callback(resp);
+    });
+}
\ No newline at end of file
@@ -23,6 +23,10 @@ public:
                         const std::string &landlordId);
 
 private:
+    // Insert review, regenerating its id on a duplicate-key collision (up to 3 attempts)
+    static void insertWithRetry(std::shared_ptr<Json::Value> review, int retry,
+                                std::function<void (const drogon::HttpResponsePtr &)> &&callback);
+
     std::string dbPath_;
     std::mutex mu_;
-};
\ No newline at end of file
+};
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "SuggestIndex.h"
+#include "Catalog.h"
+#include "NameIndex.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    // Append the folded words of text (runs of letters and digits) as terms of landlord
+    template <typename Entries>
+    void addWords(Entries &entries, const std::string &folded, uint32_t landlord) {
+        size_t i = 0;
+        while(i < folded.size()) {
+            while(i < folded.size() && !std::isalnum(static_cast<unsigned char>(folded[i]))) i++;
+            size_t start = i;
+            while(i < folded.size() && std::isalnum(static_cast<unsigned char>(folded[i]))) i++;
+            if(i > start) entries.push_back({folded.substr(start, i - start), landlord});
+        }
+    }
+}
+
+SuggestIndex::SuggestIndex(const Catalog &catalog, const std::vector<std::pair<double, uint32_t>> &scores) {
+    std::vector<Entry> entries;
+    for(uint32_t i = 0; i < catalog.landlords.size(); i++) {
+        const Landlord &landlord = catalog.landlords[i];
+        std::string name = NameIndex::fold(landlord.name);
+        if(!name.empty()) entries.push_back({name, i});
+        addWords(entries, name, i);
+        for(uint32_t p = landlord.firstProperty; p < landlord.firstProperty + landlord.propertyCount; p++) {
+            addWords(entries, NameIndex::fold(catalog.properties[p].street), i);
+            addWords(entries, NameIndex::fold(catalog.properties[p].city), i);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.term != b.term ? a.term < b.term : a.landlord < b.landlord;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.term == b.term && a.landlord == b.landlord;
+    }), entries.end());
+
+    build(entries, 0, entries.size(), 0, scores);
+}
+
+// Build the node for entries[begin, end), which share their first depth bytes. Entries are
+// sorted, so those that end at depth come first and the rest group by their next byte
+uint32_t SuggestIndex::build(const std::vector<Entry> &entries, size_t begin, size_t end, size_t depth,
+                             const std::vector<std::pair<double, uint32_t>> &scores) {
+    uint32_t index = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+
+    std::vector<uint32_t> candidates;
+    size_t i = begin;
+    for(; i < end && entries[i].term.size() == depth; i++) candidates.push_back(entries[i].landlord);
+
+    // Children are built first, then this node's edges are appended as one contiguous run
+    std::vector<Edge> edges;
+    while(i < end) {
+        char first = entries[i].term[depth];
+        size_t groupEnd = i;
+        while(groupEnd < end && entries[groupEnd].term[depth] == first) groupEnd++;
+
+        // The label runs to the longest prefix the whole group shares, which for sorted
+        // entries is the one its first and last entries share
+        const std::string &low = entries[i].term;
+        const std::string &high = entries[groupEnd - 1].term;
+        size_t shared = depth + 1;
+        while(shared < low.size() && shared < high.size() && low[shared] == high[shared]) shared++;
+
+        Edge edge;
+        edge.first = first;
+        edge.labelOffset = static_cast<uint32_t>(labels_.size());
+        edge.labelLength = static_cast<uint32_t>(shared - depth);
+        labels_.append(low, depth, shared - depth);
+        edge.child = build(entries, i, groupEnd, shared, scores);
+        edges.push_back(edge);
+
+        const Node &child = nodes_[edge.child];
+        candidates.insert(candidates.end(), tops_.begin() + child.firstTop, tops_.begin() + child.firstTop + child.topCount);
+        i = groupEnd;
+    }
+
+    // Keep the best TOP_K distinct landlords; ties go to the earlier catalog position
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    size_t keep = std::min(candidates.size(), TOP_K);
+    std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), [&scores](uint32_t a, uint32_t b) {
+        if(scores[a] != scores[b]) return scores[a] > scores[b];
+        return a < b;
+    });
+
+    Node &node = nodes_[index];
+    node.firstEdge = static_cast<uint32_t>(edges_.size());
+    node.edgeCount = static_cast<uint32_t>(edges.size());
+    edges_.insert(edges_.end(), edges.begin(), edges.end());
+    node.firstTop = static_cast<uint32_t>(tops_.size());
+    node.topCount = static_cast<uint32_t>(keep);
+    tops_.insert(tops_.end(), candidates.begin(), candidates.begin() + keep);
+    return index;
+}
+
+std::vector<uint32_t> SuggestIndex::lookup(const std::string &prefix, size_t limit) const {
+    std::string folded = NameIndex::fold(prefix);
+    uint32_t node = 0;
+    size_t matched = 0;
+    while(matched < folded.size()) {
+        const Node &current = nodes_[node];
+        auto begin = edges_.begin() + current.firstEdge;
+        auto end = begin + current.edgeCount;
+        auto edge = std::lower_bound(begin, end, folded[matched], [](const Edge &e, char c) {
+            return static_cast<unsigned char>(e.first) < static_cast<unsigned char>(c);
+        });
+        if(edge == end || edge->first != folded[matched]) return {};
+
+        // The prefix may end partway along the label
+        size_t length = std::min<size_t>(edge->labelLength, folded.size() - matched);
+        if(labels_.compare(edge->labelOffset, length, folded, matched, length) != 0) return {};
+        matched += length;
+        node = edge->child;
+    }
+
+    const Node &found = nodes_[node];
+    size_t count = std::min<size_t>(found.topCount, limit);
+    return std::vector<uint32_t>(tops_.begin() + found.firstTop, tops_.begin() + found.firstTop + count);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Catalog;
+
+/*
+    What is the SuggestIndex?
+    A radix trie for type-ahead over one catalog snapshot. Its terms are each landlord's
+    folded full name, the words of that name, and the street and city words of the
+    landlord's properties. Every node stores the top landlords below it, ranked by rating
+    when the trie was built, so a prefix lookup walks at most the length of the prefix and
+    copies out a ready-made list.
+*/
+class SuggestIndex {
+public:
+    // Most landlords kept per node, and so the most one lookup returns
+    static constexpr size_t TOP_K = 10;
+
+    // scores[i] ranks catalog.landlords[i]: the higher (average rating, review count) first
+    SuggestIndex(const Catalog &catalog, const std::vector<std::pair<double, uint32_t>> &scores);
+
+    // Positions in the catalog of up to limit landlords with a term starting with prefix,
+    // best ranked first
+    std::vector<uint32_t> lookup(const std::string &prefix, size_t limit) const;
+
+private:
+    struct Entry {
+        std::string term;
+        uint32_t landlord;
+    };
+
+    struct Node {
+        uint32_t firstEdge = 0;
+        uint32_t edgeCount = 0;
+        uint32_t firstTop = 0;
+        uint32_t topCount = 0;
+    };
+
+    struct Edge {
+        char first;             // first byte of the label, for finding the edge to follow
+        uint32_t labelOffset;   // label is labels_[labelOffset, labelOffset + labelLength)
+        uint32_t labelLength;
+        uint32_t child;
+    };
+
+    uint32_t build(const std::vector<Entry> &entries, size_t begin, size_t end, size_t depth,
+                   const std::vector<std::pair<double, uint32_t>> &scores);
+
+    // Flat arrays: the edges of a node are contiguous and sorted by first byte
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
+    std::vector<uint32_t> tops_;
+    std::string labels_;
+};
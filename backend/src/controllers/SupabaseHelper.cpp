@@ -1,5 +1,15 @@
 #include "SupabaseHelper.h"
+#include "Catalog.h"
+#include "CatalogBuilder.h"
+#include "CatalogReader.h"
+#include "JsonStream.h"
+#include "RatingStore.h"
 #include <curl/curl.h>
+#include <trantor/net/EventLoop.h>
+#include <trantor/net/EventLoopThread.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <vector>
 #include <json/json.h>
@@ -8,16 +18,11 @@
 #include <atomic>
 #include <chrono>
 #include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 
 namespace {
-    // Helper to write curl response to string
-    size_t writeToString(char *buffer, size_t size, size_t nitems, void *userdata) {
-        if(!buffer || !userdata) return 0;
-        auto *dest = static_cast<std::string*>(userdata);
-        dest->append(buffer, size * nitems);
-        return size * nitems;
-    }
-
     // Ensure curl is initialized
     bool ensureCurlInit(std::string &err) {
         static std::once_flag initFlag;
@@ -60,449 +65,964 @@ namespace {
         return true;
     }
 
-    // Simple cache with TTL (30 seconds)
-    struct CacheEntry {
-        Json::Value data;
-        std::chrono::steady_clock::time_point expiresAt;
+    // Read a positive integer setting from the environment, falling back to a default
+    long getEnvLong(const char *name, long fallback) {
+        const char *value = std::getenv(name);
+        if(!value) return fallback;
+        char *end = nullptr;
+        long parsed = std::strtol(value, &end, 10);
+        return (end != value && parsed > 0) ? parsed : fallback;
+    }
+
+    // Supabase settings and the request headers built from them. Loaded once, on first use,
+    // and shared read-only by every transfer afterwards
+    struct SupabaseConfig {
+        bool configured = false;
+        std::string baseUrl;
+        struct curl_slist *headers = nullptr;                // Content-Type, apikey, Authorization
+        struct curl_slist *representationHeaders = nullptr;  // the above plus Prefer: return=representation
+        struct curl_slist *countHeaders = nullptr;           // the above plus Prefer: count=exact
+        long poolSize = 8;                                   // SUPABASE_POOL_SIZE
+        long idleTimeoutSeconds = 60;                        // SUPABASE_POOL_IDLE_SECONDS
+        bool embeddedCatalog = true;                         // SUPABASE_CATALOG_FETCH=embedded|tables
+        long cacheSoftTtlSeconds = 30;                       // SUPABASE_CACHE_SOFT_TTL_SECONDS
+        long cacheHardTtlSeconds = 300;                      // SUPABASE_CACHE_HARD_TTL_SECONDS
+        long cacheStaleIfErrorSeconds = 3600;                // SUPABASE_CACHE_STALE_IF_ERROR_SECONDS
+
+        ~SupabaseConfig() {
+            if(headers) curl_slist_free_all(headers);
+            if(representationHeaders) curl_slist_free_all(representationHeaders);
+            if(countHeaders) curl_slist_free_all(countHeaders);
+        }
     };
-    
-    std::map<std::string, CacheEntry> cache_;
-    std::mutex cacheMutex_;
-    const int CACHE_TTL_SECONDS = 30;
-
-    bool getCached(const std::string &key, Json::Value &data) {
-        std::lock_guard<std::mutex> lock(cacheMutex_);
-        auto it = cache_.find(key);
-        if(it != cache_.end()) {
-            auto now = std::chrono::steady_clock::now();
-            if(now < it->second.expiresAt) {
-                data = it->second.data;
-                return true;
-            } else {
-                cache_.erase(it);
+
+    const SupabaseConfig &supabaseConfig() {
+        static const SupabaseConfig config = []() {
+            SupabaseConfig c;
+            std::string serviceRoleKey;
+            c.configured = getSupabaseConfig(c.baseUrl, serviceRoleKey);
+            c.poolSize = getEnvLong("SUPABASE_POOL_SIZE", c.poolSize);
+            c.idleTimeoutSeconds = getEnvLong("SUPABASE_POOL_IDLE_SECONDS", c.idleTimeoutSeconds);
+            const char *catalogFetch = std::getenv("SUPABASE_CATALOG_FETCH");
+            c.embeddedCatalog = !(catalogFetch && std::string(catalogFetch) == "tables");
+            c.cacheSoftTtlSeconds = getEnvLong("SUPABASE_CACHE_SOFT_TTL_SECONDS", c.cacheSoftTtlSeconds);
+            c.cacheHardTtlSeconds = std::max(c.cacheSoftTtlSeconds,
+                                             getEnvLong("SUPABASE_CACHE_HARD_TTL_SECONDS", c.cacheHardTtlSeconds));
+            c.cacheStaleIfErrorSeconds = std::max(c.cacheHardTtlSeconds,
+                                                  getEnvLong("SUPABASE_CACHE_STALE_IF_ERROR_SECONDS", c.cacheStaleIfErrorSeconds));
+            if(!c.configured) return c;
+
+            std::vector<std::string> headerStrings;
+            headerStrings.emplace_back("Content-Type: application/json");
+            headerStrings.emplace_back("apikey: " + serviceRoleKey);
+            headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
+            for(const auto &h : headerStrings) {
+                c.headers = curl_slist_append(c.headers, h.c_str());
+                c.representationHeaders = curl_slist_append(c.representationHeaders, h.c_str());
+                c.countHeaders = curl_slist_append(c.countHeaders, h.c_str());
             }
-        }
-        return false;
-    }
+            c.representationHeaders = curl_slist_append(c.representationHeaders, "Prefer: return=representation");
+            c.countHeaders = curl_slist_append(c.countHeaders, "Prefer: count=exact");
+            return c;
+        }();
+        return config;
+    }
+
+    /*
+        Stale-while-revalidate cache. Entries hold immutable datasets (Catalog, stats)
+        that hits share instead of copying. By age, an entry is:
+          - fresh until the soft TTL: served as is
+          - stale until the hard TTL: served at once while a background refresh runs
+          - expired until the stale-if-error window ends: refetched in the foreground,
+            but still served if that refetch fails
+        and dropped after that.
+    */
+    struct CacheEntry {
+        std::shared_ptr<const void> data;
+        std::chrono::steady_clock::time_point storedAt;
+    };
+
+    enum class CacheState { Missing, Fresh, Stale, Expired };
+
+    // One slot per cached dataset. Each slot holds an immutable snapshot that is published
+    // and read with std::atomic_store/atomic_load, so readers never take a cache-wide lock
+    // or copy the dataset; a refresh swaps in a new snapshot while readers of the old one
+    // keep theirs alive through the shared_ptr. The slot table itself never changes.
+    //
+    // generation counts invalidations. A fetch remembers the generation it started under and
+    // may only publish while that is still current, so data read before a write can never
+    // replace the invalidation. Writers (publish, invalidate) serialize on writeMutex
+    struct CacheSlot {
+        const char *key;
+        std::shared_ptr<const CacheEntry> entry;
+        std::atomic<uint64_t> generation{0};
+        std::mutex writeMutex;
+
+        CacheSlot(const char *name) : key(name) {}
+    };
 
-    void setCached(const std::string &key, const Json::Value &data) {
-        std::lock_guard<std::mutex> lock(cacheMutex_);
-        auto now = std::chrono::steady_clock::now();
-        CacheEntry entry;
-        entry.data = data;
-        entry.expiresAt = now + std::chrono::seconds(CACHE_TTL_SECONDS);
-        cache_[key] = entry;
+    CacheSlot cacheSlots_[] = {
+        {"landlords"},
+        {"stats"},
+    };
+
+    std::atomic<uint64_t> staleServed_{0};
+    std::atomic<uint64_t> staleOnError_{0};
+
+    CacheSlot *findCacheSlot(const std::string &key) {
+        for(auto &slot : cacheSlots_) {
+            if(key == slot.key) return &slot;
+        }
+        LOG_ERROR << "No cache slot for key " << key;
+        return nullptr;
+    }
+
+    template <typename T>
+    CacheState getCached(const std::string &key, std::shared_ptr<const T> &data) {
+        const auto &config = supabaseConfig();
+        CacheSlot *slot = findCacheSlot(key);
+        if(!slot) return CacheState::Missing;
+        auto entry = std::atomic_load(&slot->entry);
+        if(!entry) return CacheState::Missing;
+
+        auto age = std::chrono::steady_clock::now() - entry->storedAt;
+        if(age >= std::chrono::seconds(config.cacheStaleIfErrorSeconds)) {
+            // Drop it, unless a refresh has already replaced it
+            std::atomic_compare_exchange_strong(&slot->entry, &entry, std::shared_ptr<const CacheEntry>());
+            return CacheState::Missing;
+        }
+        data = std::static_pointer_cast<const T>(entry->data);
+        if(age < std::chrono::seconds(config.cacheSoftTtlSeconds)) return CacheState::Fresh;
+        if(age < std::chrono::seconds(config.cacheHardTtlSeconds)) return CacheState::Stale;
+        return CacheState::Expired;
+    }
+
+    uint64_t cacheGeneration(const std::string &key) {
+        CacheSlot *slot = findCacheSlot(key);
+        return slot ? slot->generation.load() : 0;
+    }
+
+    // Publish data fetched under generation; dropped, returning false, if the slot was
+    // invalidated since
+    bool setCached(const std::string &key, std::shared_ptr<const void> data, uint64_t generation) {
+        CacheSlot *slot = findCacheSlot(key);
+        if(!slot) return false;
+        auto entry = std::make_shared<CacheEntry>();
+        entry->data = std::move(data);
+        entry->storedAt = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(slot->writeMutex);
+        if(slot->generation != generation) {
+            LOG_DEBUG << "Not caching " << key << ": invalidated while it was fetched";
+            return false;
+        }
+        std::atomic_store(&slot->entry, std::shared_ptr<const CacheEntry>(std::move(entry)));
+        return true;
     }
 
     void invalidateCache(const std::string &prefix = "") {
-        std::lock_guard<std::mutex> lock(cacheMutex_);
-        if(prefix.empty()) {
-            cache_.clear();
-        } else {
-            auto it = cache_.begin();
-            while(it != cache_.end()) {
-                if(it->first.find(prefix) == 0) {
-                    it = cache_.erase(it);
-                } else {
-                    ++it;
-                }
+        for(auto &slot : cacheSlots_) {
+            if(std::string(slot.key).find(prefix) == 0) {
+                std::lock_guard<std::mutex> lock(slot.writeMutex);
+                slot.generation++;
+                std::atomic_store(&slot.entry, std::shared_ptr<const CacheEntry>());
             }
         }
     }
-}
 
-namespace SupabaseHelper {
-
-bool checkUserExists(const std::string &email, bool &exists, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false; // Fail if Supabase not configured
+    /*
+        Singleflight for cache misses: when several callers miss the same cache key at once,
+        only the first one (the originating fetch) goes to Supabase. The others are queued on
+        that in-flight fetch and all of them receive its result.
+    */
+    using FetchCallback = std::function<void(bool ok, const std::shared_ptr<const void> &data, const std::string &err)>;
+
+    std::map<std::string, std::vector<FetchCallback>> flights_;
+    std::mutex flightsMutex_;
+    std::atomic<uint64_t> originatingFetches_{0};
+    std::atomic<uint64_t> coalescedFetches_{0};
+
+    // Start fetch for key unless one is already running; either way cb gets the result
+    void fetchOnce(const std::string &key, std::function<void(FetchCallback)> fetch, FetchCallback cb) {
+        {
+            std::lock_guard<std::mutex> lock(flightsMutex_);
+            auto it = flights_.find(key);
+            if(it != flights_.end()) {
+                it->second.push_back(std::move(cb));
+                coalescedFetches_++;
+                return;
+            }
+            flights_[key].push_back(std::move(cb));
+        }
+        originatingFetches_++;
+
+        fetch([key](bool ok, const std::shared_ptr<const void> &data, const std::string &err) {
+            std::vector<FetchCallback> waiters;
+            {
+                std::lock_guard<std::mutex> lock(flightsMutex_);
+                auto it = flights_.find(key);
+                if(it != flights_.end()) {
+                    waiters.swap(it->second);
+                    flights_.erase(it);
+                }
+            }
+            for(auto &waiter : waiters) waiter(ok, data, err);
+        });
     }
 
-    if(!ensureCurlInit(err)) {
-        return false;
+    // fetchOnce for a dataset of type T, handing cb the typed pointer
+    template <typename T>
+    void fetchOnce(const std::string &key, std::function<void(FetchCallback)> fetch,
+                   std::function<void(bool, const std::shared_ptr<const T> &, const std::string &)> cb) {
+        fetchOnce(key, std::move(fetch), [cb](bool ok, const std::shared_ptr<const void> &data, const std::string &err) {
+            cb(ok, std::static_pointer_cast<const T>(data), err);
+        });
     }
 
-    std::string url = baseUrl + "/rest/v1/users?email=eq." + email + "&select=email";
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
+    // A fetch that refills a cache slot: it must hand generation to setCached
+    using CacheFetch = std::function<void(uint64_t generation, FetchCallback done)>;
+
+    // Answer cb from the cache entry for key, using fetch when the entry is missing, stale or
+    // expired. See CacheEntry for the rules. Fetches are shared per generation: a caller
+    // that arrives after an invalidation never joins a fetch that started before it
+    template <typename T>
+    void readThrough(const std::string &key, CacheFetch cacheFetch,
+                     std::function<void(bool, const std::shared_ptr<const T> &, const std::string &)> cb) {
+        uint64_t generation = cacheGeneration(key);
+        std::string flight = key + "@" + std::to_string(generation);
+        std::function<void(FetchCallback)> fetch = [cacheFetch, generation](FetchCallback done) {
+            cacheFetch(generation, std::move(done));
+        };
+
+        std::shared_ptr<const T> cached;
+        CacheState state = getCached(key, cached);
+        if(state == CacheState::Fresh) {
+            cb(true, cached, "");
+            return;
+        }
 
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
+        if(state == CacheState::Stale) {
+            staleServed_++;
+            cb(true, cached, "");
+            // Refresh in the background; concurrent stale hits share the one refresh
+            fetchOnce(flight, std::move(fetch), [key](bool ok, const std::shared_ptr<const void> &, const std::string &err) {
+                if(!ok) LOG_WARN << "Background refresh of " << key << " failed: " << err;
+            });
+            return;
+        }
 
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
+        fetchOnce<T>(flight, std::move(fetch), [key, cb, cached](bool ok, const std::shared_ptr<const T> &data, const std::string &err) {
+            if(!ok && cached) {
+                staleOnError_++;
+                LOG_WARN << "Refresh of " << key << " failed, serving expired data: " << err;
+                cb(true, cached, "");
+                return;
+            }
+            cb(ok, data, err);
+        });
     }
 
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
+    // One call to the Supabase REST API
+    struct SupabaseRequest {
+        std::string method = "GET";
+        std::string path;                   // e.g. "/rest/v1/users?select=email"
+        std::string body;                   // JSON payload for POST
+        bool returnRepresentation = false;  // adds "Prefer: return=representation"
+        bool countOnly = false;             // HEAD with "Prefer: count=exact"; no rows are sent back
+        // Reads the body as it arrives instead of building SupabaseResponse::json
+        std::shared_ptr<JsonSaxHandler> reader;
+    };
 
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    // Outcome of a SupabaseRequest. ok is true only for a completed 2xx exchange
+    struct SupabaseResponse {
+        bool ok = false;
+        long httpCode = 0;
+        Json::Value json;                   // the response body, parsed while it was received (unless read by a reader)
+        bool parsed = false;                // true if the whole body was valid JSON
+        std::string body;                   // start of the raw body, kept for error messages
+        long long count = -1;               // total row count from Content-Range, if the server sent one
+        std::string err;
+    };
 
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
+    // How much of the raw body a response keeps alongside the parsed JSON
+    const size_t RAW_BODY_LIMIT = 4096;
+
+    using ResponseHandler = std::function<void(SupabaseResponse &&)>;
+
+    /*
+        HandlePool keeps finished easy handles around so the next request can borrow one
+        instead of calling curl_easy_init again. Every handle is attached to one CURLSH
+        share that holds the DNS and TLS session caches, so lookups and TLS session
+        tickets survive across requests. Live connections themselves are cached by the
+        transfer loop's multi handle, which keeps them open (keep-alive, HTTP/2 multiplexed
+        where the server supports it) for idleTimeoutSeconds.
+    */
+    class HandlePool {
+    public:
+        HandlePool() : share_(curl_share_init()) {
+            curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lockShare);
+            curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlockShare);
+            curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
 
-    // Parse response - if array has items, user exists
-    Json::Value responseJson;
-    Json::Reader reader;
-    if(reader.parse(responseBody, responseJson) && responseJson.isArray()) {
-        exists = responseJson.size() > 0;
-    } else {
-        exists = false;
-    }
+        ~HandlePool() {
+            for(auto &idle : idle_) curl_easy_cleanup(idle.curl);
+            curl_share_cleanup(share_);
+        }
 
-    return true;
-}
+        // Hand out an idle handle, or a new one when the pool is empty
+        CURL *borrow() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(!idle_.empty()) {
+                    CURL *curl = idle_.back().curl;
+                    idle_.pop_back();
+                    handlesReused_++;
+                    return curl;
+                }
+            }
+            CURL *curl = curl_easy_init();
+            if(curl) handlesCreated_++;
+            return curl;
+        }
 
-bool insertUser(const std::string &email,
-                const std::string &name,
-                const std::string &password_plain,
-                const std::string &password_hashed,
-                int admin,
-                std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false; // Fail if Supabase not configured
-    }
+        // Take a handle back once its transfer is done; handles beyond the pool size are closed
+        void giveBack(CURL *curl) {
+            curl_easy_reset(curl);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(static_cast<long>(idle_.size()) >= supabaseConfig().poolSize) {
+                curl_easy_cleanup(curl);
+                return;
+            }
+            idle_.push_back({curl, std::chrono::steady_clock::now()});
+        }
 
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
+        // Close handles that have sat unused for longer than the idle timeout
+        void evictIdle() {
+            auto cutoff = std::chrono::steady_clock::now() - std::chrono::seconds(supabaseConfig().idleTimeoutSeconds);
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = idle_.begin();
+            while(it != idle_.end()) {
+                if(it->since < cutoff) {
+                    curl_easy_cleanup(it->curl);
+                    it = idle_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
 
-    std::string url = baseUrl + "/rest/v1/users";
+        CURLSH *share() const { return share_; }
 
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
+        size_t idleCount() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return idle_.size();
+        }
 
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-    headerStrings.emplace_back("Prefer: return=representation");
+        std::atomic<uint64_t> handlesCreated_{0};
+        std::atomic<uint64_t> handlesReused_{0};
 
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
+    private:
+        struct IdleHandle {
+            CURL *curl;
+            std::chrono::steady_clock::time_point since;
+        };
 
-    Json::Value payload(Json::objectValue);
-    payload["email"] = email;
-    payload["name"] = name;
-    payload["password_hashed"] = password_hashed;
-    payload["password_plain"] = password_plain;
-    payload["admin"] = admin;
-    Json::StreamWriterBuilder writer;
-    const std::string body = Json::writeString(writer, payload);
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
+        static void lockShare(CURL *, curl_lock_data data, curl_lock_access, void *userptr) {
+            static_cast<HandlePool*>(userptr)->shareLocks_[data % CURL_LOCK_DATA_LAST].lock();
+        }
 
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+        static void unlockShare(CURL *, curl_lock_data data, void *userptr) {
+            static_cast<HandlePool*>(userptr)->shareLocks_[data % CURL_LOCK_DATA_LAST].unlock();
+        }
 
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
+        CURLSH *share_;
+        std::mutex mutex_;
+        std::vector<IdleHandle> idle_;
+        std::mutex shareLocks_[CURL_LOCK_DATA_LAST];
+    };
 
-    return true;
-}
+    HandlePool &handlePool() {
+        static HandlePool pool;
+        return pool;
+    }
+
+    // An easy handle travelling through the transfer loop, with everything it points at.
+    // The response body is parsed as curl delivers it, so it is never buffered in full
+    struct Transfer {
+        CURL *curl = nullptr;
+        std::string url;
+        std::string payload;
+        SupabaseResponse response;
+        ResponseHandler handler;
+        JsonValueBuilder builder;
+        std::shared_ptr<JsonSaxHandler> reader;
+        std::unique_ptr<JsonStreamParser> parser;
+
+        ~Transfer() {
+            if(curl) handlePool().giveBack(curl);
+        }
+    };
 
-bool getUserAdminStatus(const std::string &email, bool &isAdmin, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
+    // curl write callback: feed the received chunk to the transfer's JSON parser
+    size_t writeToParser(char *buffer, size_t size, size_t nitems, void *userdata) {
+        if(!buffer || !userdata) return 0;
+        auto *transfer = static_cast<Transfer*>(userdata);
+        size_t length = size * nitems;
+        std::string &raw = transfer->response.body;
+        if(raw.size() < RAW_BODY_LIMIT) {
+            raw.append(buffer, std::min(length, RAW_BODY_LIMIT - raw.size()));
+        }
+        // A body that is not JSON is not an error here; the parser just stops and the
+        // response is reported as unparsed
+        transfer->parser->feed(buffer, length);
+        return length;
+    }
+
+    // curl header callback: pick the total out of "Content-Range: 0-24/3573" (or "*/3573")
+    size_t readContentRange(char *buffer, size_t size, size_t nitems, void *userdata) {
+        size_t length = size * nitems;
+        if(!buffer || !userdata) return length;
+        static const std::string name = "content-range:";
+        if(length <= name.size()) return length;
+        for(size_t i = 0; i < name.size(); i++) {
+            if(std::tolower(static_cast<unsigned char>(buffer[i])) != name[i]) return length;
+        }
+        std::string value(buffer + name.size(), length - name.size());
+        size_t slash = value.rfind('/');
+        if(slash == std::string::npos) return length;
+        char *end = nullptr;
+        long long total = std::strtoll(value.c_str() + slash + 1, &end, 10);
+        if(end != value.c_str() + slash + 1) {
+            static_cast<Transfer*>(userdata)->response.count = total;
+        }
+        return length;
+    }
+
+    /*
+        TransferLoop owns one curl multi handle and a background thread that drives it.
+        Handlers submit transfers and return immediately; the thread performs all network
+        I/O and runs each transfer's completion handler when the exchange finishes.
+    */
+    class TransferLoop {
+    public:
+        static TransferLoop &instance() {
+            static TransferLoop loop;
+            return loop;
+        }
 
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
+        void submit(std::unique_ptr<Transfer> transfer) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queued_.push_back(transfer.release());
+            }
+            curl_multi_wakeup(multi_);
+        }
 
-    std::string url = baseUrl + "/rest/v1/users?email=eq." + email + "&select=admin";
+        std::atomic<uint64_t> transfers_{0};
+        std::atomic<uint64_t> reusedConnections_{0};
+        std::atomic<uint64_t> inFlight_{0};
+
+    private:
+        TransferLoop() : multi_(curl_multi_init()) {
+            const auto &config = supabaseConfig();
+            curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+            curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, config.poolSize);
+            curl_multi_setopt(multi_, CURLMOPT_MAXCONNECTS, config.poolSize);
+            thread_ = std::thread([this]() { run(); });
+        }
 
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
+        ~TransferLoop() {
+            stopping_ = true;
+            curl_multi_wakeup(multi_);
+            if(thread_.joinable()) thread_.join();
+            for(auto *transfer : queued_) delete transfer;
+            curl_multi_cleanup(multi_);
+        }
 
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
+        void run() {
+            auto lastEviction = std::chrono::steady_clock::now();
+            while(!stopping_) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    for(auto *transfer : queued_) {
+                        curl_multi_add_handle(multi_, transfer->curl);
+                        inFlight_++;
+                    }
+                    queued_.clear();
+                }
 
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
+                int running = 0;
+                curl_multi_perform(multi_, &running);
+
+                int remaining = 0;
+                while(CURLMsg *msg = curl_multi_info_read(multi_, &remaining)) {
+                    if(msg->msg != CURLMSG_DONE) continue;
+                    Transfer *raw = nullptr;
+                    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &raw);
+                    curl_multi_remove_handle(multi_, msg->easy_handle);
+                    inFlight_--;
+                    finish(std::unique_ptr<Transfer>(raw), msg->data.result);
+                }
 
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
+                auto now = std::chrono::steady_clock::now();
+                if(now - lastEviction > std::chrono::seconds(10)) {
+                    handlePool().evictIdle();
+                    lastEviction = now;
+                }
 
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+                curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+            }
+        }
 
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
+        void finish(std::unique_ptr<Transfer> transfer, CURLcode res) {
+            SupabaseResponse &response = transfer->response;
+            if(res != CURLE_OK) {
+                response.err = curl_easy_strerror(res);
+            } else {
+                // NUM_CONNECTS is 0 when the request went out on an already open connection
+                long newConnections = 0;
+                curl_easy_getinfo(transfer->curl, CURLINFO_NUM_CONNECTS, &newConnections);
+                transfers_++;
+                if(newConnections == 0) reusedConnections_++;
+
+                curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &response.httpCode);
+                if(transfer->parser->finish()) {
+                    if(!transfer->reader) response.json = std::move(transfer->builder.result());
+                    response.parsed = true;
+                }
+                if(response.httpCode < 200 || response.httpCode >= 300) {
+                    response.err = "supabase returned HTTP " + std::to_string(response.httpCode) + ": " + response.body;
+                } else {
+                    response.ok = true;
+                }
+            }
 
-    // Parse response - check if admin field is 1
-    Json::Value responseJson;
-    Json::Reader reader;
-    if(reader.parse(responseBody, responseJson) && responseJson.isArray() && responseJson.size() > 0) {
-        const auto &user = responseJson[0];
-        isAdmin = user.get("admin", 0).asInt() == 1;
-    } else {
-        isAdmin = false; // User not found or invalid response
-    }
+            try {
+                transfer->handler(std::move(response));
+            } catch(const std::exception &e) {
+                LOG_ERROR << "Supabase completion handler threw: " << e.what();
+            }
+        }
 
-    return true;
-}
+        CURLM *multi_;
+        std::thread thread_;
+        std::mutex mutex_;
+        std::vector<Transfer*> queued_;
+        std::atomic<bool> stopping_{false};
+    };
 
-bool getUserData(const std::string &email, std::string &name, bool &isAdmin, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
+    // Queue a request on the transfer loop. handler runs on the transfer thread, or inline
+    // if the request could not be started
+    void sendRequest(const SupabaseRequest &request, ResponseHandler handler) {
+        SupabaseResponse failure;
+        const auto &config = supabaseConfig();
+        if(!config.configured) {
+            failure.err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
+            handler(std::move(failure));
+            return;
+        }
 
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
+        if(!ensureCurlInit(failure.err)) {
+            handler(std::move(failure));
+            return;
+        }
 
-    std::string url = baseUrl + "/rest/v1/users?email=eq." + email + "&select=name,admin";
+        auto transfer = std::make_unique<Transfer>();
+        transfer->curl = handlePool().borrow();
+        if(!transfer->curl) {
+            failure.err = "failed to construct supabase client";
+            handler(std::move(failure));
+            return;
+        }
 
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
+        transfer->url = config.baseUrl + request.path;
+        transfer->payload = request.body;
+        transfer->handler = std::move(handler);
+        transfer->reader = request.reader;
+        transfer->parser = std::make_unique<JsonStreamParser>(transfer->reader ? *transfer->reader : transfer->builder);
+
+        CURL *curl = transfer->curl;
+        curl_easy_setopt(curl, CURLOPT_URL, transfer->url.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request.countOnly ? config.countHeaders
+                                                   : request.returnRepresentation ? config.representationHeaders
+                                                   : config.headers);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToParser);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, transfer.get());
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+        curl_easy_setopt(curl, CURLOPT_SHARE, handlePool().share());
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, config.idleTimeoutSeconds);
+        if(request.countOnly) {
+            curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+            curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, readContentRange);
+            curl_easy_setopt(curl, CURLOPT_HEADERDATA, transfer.get());
+        } else if(request.method == "POST") {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer->payload.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer->payload.size()));
+        } else if(request.method != "GET") {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+        }
 
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
+        TransferLoop::instance().submit(std::move(transfer));
+    }
 
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
+    // Wrap cb so that it runs on the event loop that is current right now. Calls made
+    // outside of an event loop get their callback on the transfer thread instead
+    template <typename... Args>
+    std::function<void(Args...)> onCallerLoop(std::function<void(Args...)> cb) {
+        auto *loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+        if(!loop) return cb;
+        return [loop, cb = std::move(cb)](Args... args) {
+            loop->queueInLoop([cb, args...]() { cb(args...); });
+        };
     }
 
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
+    // Take the parsed body of a PostgREST response that is expected to be a JSON array
+    bool parseArray(SupabaseResponse &resp, Json::Value &out) {
+        if(!resp.parsed || !resp.json.isArray()) return false;
+        out = std::move(resp.json);
+        return true;
     }
 
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    std::string writeJson(const Json::Value &payload) {
+        Json::StreamWriterBuilder writer;
+        return Json::writeString(writer, payload);
+    }
 
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
+    // Shared by every write whose only result is success or failure
+    ResponseHandler completeWith(SupabaseHelper::DoneCallback cb) {
+        return [cb](SupabaseResponse &&resp) {
+            cb(resp.ok, resp.err);
+        };
     }
 
-    // Parse response
-    Json::Value responseJson;
-    Json::Reader reader;
-    if(reader.parse(responseBody, responseJson) && responseJson.isArray() && responseJson.size() > 0) {
-        const auto &user = responseJson[0];
-        name = user.get("name", "").asString();
-        isAdmin = user.get("admin", 0).asInt() == 1;
-    } else {
-        err = "user not found";
-        return false;
+    // Shared by every read that returns a JSON array unchanged
+    ResponseHandler completeWithArray(SupabaseHelper::JsonCallback cb) {
+        return [cb](SupabaseResponse &&resp) {
+            if(!resp.ok) {
+                cb(false, Json::Value(), resp.err);
+                return;
+            }
+            Json::Value result;
+            if(!parseArray(resp, result)) {
+                cb(false, Json::Value(), "invalid response format from Supabase");
+                return;
+            }
+            cb(true, result, "");
+        };
+    }
+
+    // Look up a single user row; fails with "user not found" if there is none
+    void getUserRow(const std::string &email, const std::string &select, SupabaseHelper::JsonCallback cb) {
+        SupabaseRequest request;
+        request.path = "/rest/v1/users?email=eq." + email + "&select=" + select;
+        sendRequest(request, [cb](SupabaseResponse &&resp) {
+            if(!resp.ok) {
+                cb(false, Json::Value(), resp.err);
+                return;
+            }
+            Json::Value responseJson;
+            if(parseArray(resp, responseJson) && responseJson.size() > 0) {
+                cb(true, responseJson[0], "");
+            } else {
+                cb(false, Json::Value(), "user not found");
+            }
+        });
     }
 
-    return true;
-}
+    // State threaded through a landlord insert: the landlord row, then every property in one
+    // bulk insert, then every unit in one bulk insert. PostgREST runs each bulk insert as a
+    // single statement, so a batch is either stored whole or not at all
+    struct LandlordInsert {
+        std::string landlordId;
+        Json::Value propertyRows = Json::Value(Json::arrayValue);
+        Json::Value unitRows = Json::Value(Json::arrayValue);
+        SupabaseHelper::DoneCallback cb;
+    };
 
-bool getUserPasswordHash(const std::string &email, std::string &password_hashed, std::string &password_plain, std::string &name, int &admin, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
+    // Flatten the nested properties[].unit_details[] of a new landlord into table rows
+    void buildLandlordRows(LandlordInsert &state, const Json::Value &properties) {
+        if(!properties.isArray()) return;
+        for(const auto &prop : properties) {
+            std::string propertyId = prop["property_id"].asString();
+            Json::Value propRow(Json::objectValue);
+            propRow["property_id"] = propertyId;
+            propRow["landlord_id"] = state.landlordId;
+            propRow["street"] = prop["address"]["street"].asString();
+            propRow["city"] = prop["address"]["city"].asString();
+            propRow["province"] = prop["address"].get("province", prop["address"].get("state", "")).asString();
+            propRow["zip"] = prop["address"]["zip"].asString();
+            state.propertyRows.append(propRow);
+
+            const auto &units = prop["unit_details"];
+            if(!units.isArray()) continue;
+            for(const auto &unit : units) {
+                Json::Value unitRow(Json::objectValue);
+                unitRow["property_id"] = propertyId;
+                unitRow["unit_number"] = unit.get("unit_number", "").asString();
+                unitRow["bedrooms"] = unit.get("bedrooms", 0).asInt();
+                unitRow["bathrooms"] = unit.get("bathrooms", 0).asDouble();
+                unitRow["rent"] = unit.get("rent", 0).asInt();
+                state.unitRows.append(unitRow);
+            }
+        }
     }
 
-    if(!ensureCurlInit(err)) {
-        return false;
+    // Remove what a failed landlord insert already stored (its properties, then the landlord
+    // row) so no half-created landlord is left behind, then report the original failure
+    void rollbackLandlord(std::shared_ptr<LandlordInsert> state, const std::string &err) {
+        SupabaseRequest deleteProperties;
+        deleteProperties.method = "DELETE";
+        deleteProperties.path = "/rest/v1/properties?landlord_id=eq." + state->landlordId;
+        sendRequest(deleteProperties, [state, err](SupabaseResponse &&resp) {
+            if(!resp.ok) {
+                LOG_ERROR << "Rollback of properties for landlord " << state->landlordId << " failed: " << resp.err;
+            }
+            SupabaseRequest deleteLandlord;
+            deleteLandlord.method = "DELETE";
+            deleteLandlord.path = "/rest/v1/landlords?landlord_id=eq." + state->landlordId;
+            sendRequest(deleteLandlord, [state, err](SupabaseResponse &&resp) {
+                if(!resp.ok) {
+                    LOG_ERROR << "Rollback of landlord " << state->landlordId << " failed: " << resp.err;
+                }
+                state->cb(false, err);
+            });
+        });
     }
 
-    std::string url = baseUrl + "/rest/v1/users?email=eq." + email + "&select=password_hashed,password_plain,name,admin";
+    void insertLandlordUnits(std::shared_ptr<LandlordInsert> state) {
+        if(state->unitRows.empty()) {
+            state->cb(true, "");
+            return;
+        }
+        SupabaseRequest request;
+        request.method = "POST";
+        request.path = "/rest/v1/units";
+        request.body = writeJson(state->unitRows);
+        sendRequest(request, [state](SupabaseResponse &&resp) {
+            if(!resp.ok) {
+                rollbackLandlord(state, "units insert failed: " + resp.err);
+                return;
+            }
+            state->cb(true, "");
+        });
+    }
 
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
+    void insertLandlordProperties(std::shared_ptr<LandlordInsert> state) {
+        if(state->propertyRows.empty()) {
+            state->cb(true, "");
+            return;
+        }
+        SupabaseRequest request;
+        request.method = "POST";
+        request.path = "/rest/v1/properties";
+        request.body = writeJson(state->propertyRows);
+        sendRequest(request, [state](SupabaseResponse &&resp) {
+            if(!resp.ok) {
+                rollbackLandlord(state, "properties insert failed: " + resp.err);
+                return;
+            }
+            insertLandlordUnits(state);
+        });
     }
 
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
+    // Issue several requests at once on the transfer loop and call done when all of them have
+    // completed, with the responses in the same order as the requests
+    void sendRequests(const std::vector<SupabaseRequest> &requests,
+                      std::function<void(std::vector<SupabaseResponse> &&)> done) {
+        struct FanOut {
+            std::vector<SupabaseResponse> responses;
+            std::atomic<size_t> remaining{0};
+            std::function<void(std::vector<SupabaseResponse> &&)> done;
+        };
+        auto state = std::make_shared<FanOut>();
+        state->responses.resize(requests.size());
+        state->remaining = requests.size();
+        state->done = std::move(done);
+
+        for(size_t i = 0; i < requests.size(); i++) {
+            sendRequest(requests[i], [state, i](SupabaseResponse &&resp) {
+                state->responses[i] = std::move(resp);
+                if(--state->remaining == 0) {
+                    state->done(std::move(state->responses));
+                }
+            });
+        }
+    }
 
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
+    // Check that each table response of a fan-out was read in full by its reader. Returns
+    // false and describes every table that failed (transport, HTTP or format error) in err
+    bool checkTables(const std::vector<std::string> &names,
+                     const std::vector<SupabaseResponse> &responses,
+                     const std::vector<std::shared_ptr<CatalogReader>> &readers,
+                     std::string &err) {
+        for(size_t i = 0; i < responses.size(); i++) {
+            std::string failure;
+            if(!responses[i].ok) {
+                failure = responses[i].err;
+            } else if(!responses[i].parsed || !readers[i]->valid()) {
+                failure = "invalid " + names[i] + " response format from Supabase";
+            }
+            if(!failure.empty()) {
+                if(!err.empty()) err += "; ";
+                err += names[i] + " fetch failed: " + failure;
+            }
+        }
+        return err.empty();
+    }
+
+    // Join and index a fully read catalog and hand it to cb. For a large catalog this takes
+    // long enough to hold up every other transfer, so it runs on a thread of its own, which
+    // then also builds the fuzzy index so the first fuzzy search does not have to
+    void indexCatalog(std::shared_ptr<CatalogBuilder> builder, SupabaseHelper::CatalogCallback cb) {
+        static trantor::EventLoopThread thread("CatalogIndex");
+        static std::once_flag started;
+        std::call_once(started, []() { thread.run(); });
+        thread.getLoop()->queueInLoop([builder = std::move(builder), cb = std::move(cb)]() {
+            std::shared_ptr<Catalog> catalog = builder->join();
+            catalog->index();
+            cb(true, catalog, "");
+            catalog->indexFuzzy();
+        });
     }
 
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
+    // Catalog fetch strategy 1: landlords, properties and units as three concurrent table
+    // scans, each read straight into one CatalogBuilder and joined once all three are in.
+    // The readers touch only their own table's rows, and all run on the transfer thread
+    void fetchCatalogTables(SupabaseHelper::CatalogCallback cb) {
+        const std::vector<std::string> tableNames = {"landlords", "properties", "units"};
+        auto builder = std::make_shared<CatalogBuilder>();
+        std::vector<std::shared_ptr<CatalogReader>> readers = {
+            std::make_shared<CatalogReader>(*builder, CatalogReader::Table::Landlords),
+            std::make_shared<CatalogReader>(*builder, CatalogReader::Table::Properties),
+            std::make_shared<CatalogReader>(*builder, CatalogReader::Table::Units),
+        };
+        std::vector<SupabaseRequest> requests(3);
+        requests[0].path = "/rest/v1/landlords?select=landlord_id,name,contact_email,contact_phone";
+        requests[1].path = "/rest/v1/properties?select=property_id,landlord_id,street,city,province,zip";
+        requests[2].path = "/rest/v1/units?select=property_id,unit_number,bedrooms,bathrooms,rent";
+        for(size_t i = 0; i < requests.size(); i++) requests[i].reader = readers[i];
+        sendRequests(requests, [cb, tableNames, builder, readers](std::vector<SupabaseResponse> &&responses) {
+            std::string err;
+            if(!checkTables(tableNames, responses, readers, err)) {
+                cb(false, nullptr, err);
+                return;
+            }
+            indexCatalog(builder, cb);
+        });
     }
 
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    // Set once PostgREST rejects the embedded select (e.g. no properties/units foreign keys),
+    // so later refreshes go straight to the table scans
+    std::atomic<bool> embeddedCatalogUnsupported{false};
+
+    // Catalog fetch strategy 2: one request using PostgREST resource embedding, which returns
+    // landlords with their properties and units already nested. Falls back to the table scans
+    // if the request fails
+    void fetchCatalogEmbedded(SupabaseHelper::CatalogCallback cb) {
+        SupabaseRequest request;
+        request.path = "/rest/v1/landlords?select=landlord_id,name,contact_email,contact_phone,"
+                       "properties(property_id,street,city,province,zip,"
+                       "units(unit_number,bedrooms,bathrooms,rent))";
+        auto builder = std::make_shared<CatalogBuilder>();
+        auto reader = std::make_shared<CatalogReader>(*builder, CatalogReader::Table::Embedded);
+        request.reader = reader;
+        sendRequest(request, [cb, builder, reader](SupabaseResponse &&resp) {
+            if(resp.ok && resp.parsed && reader->valid()) {
+                indexCatalog(builder, cb);
+                return;
+            }
 
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
+            std::string reason = resp.ok ? "invalid response format" : resp.err;
+            if(resp.httpCode >= 400 && resp.httpCode < 500) {
+                embeddedCatalogUnsupported = true;
+            }
+            LOG_WARN << "Embedded catalog fetch failed, falling back to table scans: " << reason;
+            fetchCatalogTables(cb);
+        });
     }
+}
 
-    // Parse response
-    Json::Value responseJson;
-    Json::Reader reader;
-    if(reader.parse(responseBody, responseJson) && responseJson.isArray() && responseJson.size() > 0) {
-        const auto &user = responseJson[0];
-        password_hashed = user.get("password_hashed", "").asString();
-        password_plain = user.get("password_plain", "").asString();
-        name = user.get("name", "").asString();
-        admin = user.get("admin", 0).asInt();
-    } else {
-        err = "user not found";
-        return false;
-    }
+namespace SupabaseHelper {
 
-    return true;
+void checkUserExists(const std::string &email, FlagCallback cb) {
+    cb = onCallerLoop(std::move(cb));
+    SupabaseRequest request;
+    request.path = "/rest/v1/users?email=eq." + email + "&select=email";
+    sendRequest(request, [cb](SupabaseResponse &&resp) {
+        if(!resp.ok) {
+            cb(false, false, resp.err);
+            return;
+        }
+        // Parse response - if array has items, user exists
+        Json::Value responseJson;
+        bool exists = parseArray(resp, responseJson) && responseJson.size() > 0;
+        cb(true, exists, "");
+    });
 }
 
-bool insertReview(const std::string &id,
-                 const std::string &landlord_id,
-                 int rating,
-                 const std::string &title,
-                 const std::string &review,
-                 const std::string &created_at,
-                 std::string &err) {
-    // Invalidate reviews cache when a new review is added
-    invalidateCache("reviews");
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
+void insertUser(const std::string &email,
+                const std::string &name,
+                const std::string &password_plain,
+                const std::string &password_hashed,
+                int admin,
+                DoneCallback cb) {
+    cb = onCallerLoop(std::move(cb));
+    Json::Value payload(Json::objectValue);
+    payload["email"] = email;
+    payload["name"] = name;
+    payload["password_hashed"] = password_hashed;
+    payload["password_plain"] = password_plain;
+    payload["admin"] = admin;
 
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
+    SupabaseRequest request;
+    request.method = "POST";
+    request.path = "/rest/v1/users";
+    request.body = writeJson(payload);
+    request.returnRepresentation = true;
+    sendRequest(request, completeWith(cb));
+}
 
-    std::string url = baseUrl + "/rest/v1/reviews";
+void getUserAdminStatus(const std::string &email, FlagCallback cb) {
+    cb = onCallerLoop(std::move(cb));
+    SupabaseRequest request;
+    request.path = "/rest/v1/users?email=eq." + email + "&select=admin";
+    sendRequest(request, [cb](SupabaseResponse &&resp) {
+        if(!resp.ok) {
+            cb(false, false, resp.err);
+            return;
+        }
+        // Parse response - check if admin field is 1
+        Json::Value responseJson;
+        bool isAdmin = false; // User not found or invalid response
+        if(parseArray(resp, responseJson) && responseJson.size() > 0) {
+            isAdmin = responseJson[0].get("admin", 0).asInt() == 1;
+        }
+        cb(true, isAdmin, "");
+    });
+}
 
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
+void getUserData(const std::string &email, JsonCallback cb) {
+    getUserRow(email, "name,admin", onCallerLoop(std::move(cb)));
+}
 
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-    headerStrings.emplace_back("Prefer: return=representation");
+void getUserPasswordHash(const std::string &email, JsonCallback cb) {
+    getUserRow(email, "password_hashed,password_plain,name,admin", onCallerLoop(std::move(cb)));
+}
 
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
+void insertReview(const std::string &id,
+                  const std::string &landlord_id,
+                  int rating,
+                  const std::string &title,
+                  const std::string &review,
+                  const std::string &created_at,
+                  DoneCallback cb) {
+    cb = onCallerLoop(std::move(cb));
 
     Json::Value payload(Json::objectValue);
     payload["id"] = id;
@@ -511,477 +1031,113 @@ bool insertReview(const std::string &id,
     payload["title"] = title;
     payload["review"] = review;
     payload["created_at"] = created_at;
-    Json::StreamWriterBuilder writer;
-    const std::string body = Json::writeString(writer, payload);
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
 
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    return true;
+    SupabaseRequest request;
+    request.method = "POST";
+    request.path = "/rest/v1/reviews";
+    request.body = writeJson(payload);
+    request.returnRepresentation = true;
+    sendRequest(request, completeWith(cb));
 }
 
-bool getReviewsForLandlord(const std::string &landlord_id, Json::Value &reviewsJson, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/reviews?landlord_id=eq." + landlord_id + "&order=created_at.desc";
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    // Parse response
-    Json::Reader reader;
-    if(!reader.parse(responseBody, reviewsJson) || !reviewsJson.isArray()) {
-        err = "invalid response format from Supabase";
-        return false;
-    }
-
-    return true;
+void getReviewsForLandlord(const std::string &landlord_id, JsonCallback cb) {
+    SupabaseRequest request;
+    request.path = "/rest/v1/reviews?landlord_id=eq." + landlord_id + "&order=created_at.desc";
+    sendRequest(request, completeWithArray(onCallerLoop(std::move(cb))));
 }
 
-bool getAllReviews(Json::Value &reviewsJson, std::string &err) {
-    // Check cache first
-    if(getCached("reviews", reviewsJson)) {
-        return true;
-    }
-
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/reviews?select=landlord_id,rating&order=created_at.desc";
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    // Parse response
-    Json::Reader reader;
-    if(!reader.parse(responseBody, reviewsJson) || !reviewsJson.isArray()) {
-        err = "invalid response format from Supabase";
-        return false;
-    }
-
-    // Cache the result
-    setCached("reviews", reviewsJson);
-
-    return true;
+void getAllReviews(ReviewsCallback cb) {
+    cb = onCallerLoop(std::move(cb));
+
+    // Not cached: the rating aggregates are the only reader and keep their own state.
+    // Concurrent loads still share one request
+    fetchOnce<ReviewSet>("reviews", [](FetchCallback done) {
+        SupabaseRequest request;
+        request.path = "/rest/v1/reviews?select=id,landlord_id,rating";
+        auto reviews = std::make_shared<ReviewSet>();
+        auto reader = std::make_shared<ReviewReader>(*reviews);
+        request.reader = reader;
+        sendRequest(request, [done, reviews, reader](SupabaseResponse &&resp) {
+            if(!resp.ok) {
+                done(false, nullptr, resp.err);
+                return;
+            }
+            if(!resp.parsed || !reader->valid()) {
+                done(false, nullptr, "invalid response format from Supabase");
+                return;
+            }
+            done(true, reviews, "");
+        });
+    }, cb);
 }
 
-bool getAllLandlords(Json::Value &landlordsJson, std::string &err) {
-    // Check cache first
-    if(getCached("landlords", landlordsJson)) {
-        return true;
-    }
-
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    // Fetch landlords
-    std::string landlordsUrl = baseUrl + "/rest/v1/landlords?select=landlord_id,name,contact_email,contact_phone";
-    
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
+void getAllLandlords(CatalogCallback cb) {
+    cb = onCallerLoop(std::move(cb));
 
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    std::string landlordsBody;
-    curl_easy_setopt(curl, CURLOPT_URL, landlordsUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &landlordsBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + landlordsBody;
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    // Parse landlords
-    Json::Value landlordsArray;
-    Json::Reader reader;
-    if(!reader.parse(landlordsBody, landlordsArray) || !landlordsArray.isArray()) {
-        err = "invalid landlords response format from Supabase";
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    // Fetch properties
-    std::string propertiesUrl = baseUrl + "/rest/v1/properties?select=property_id,landlord_id,street,city,province,zip";
-    std::string propertiesBody;
-    curl_easy_setopt(curl, CURLOPT_URL, propertiesUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &propertiesBody);
-    res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + propertiesBody;
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    Json::Value propertiesArray;
-    if(!reader.parse(propertiesBody, propertiesArray) || !propertiesArray.isArray()) {
-        err = "invalid properties response format from Supabase";
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    // Fetch units
-    std::string unitsUrl = baseUrl + "/rest/v1/units?select=property_id,unit_number,bedrooms,bathrooms,rent";
-    std::string unitsBody;
-    curl_easy_setopt(curl, CURLOPT_URL, unitsUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &unitsBody);
-    res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + unitsBody;
-        return false;
-    }
-
-    Json::Value unitsArray;
-    if(!reader.parse(unitsBody, unitsArray) || !unitsArray.isArray()) {
-        err = "invalid units response format from Supabase";
-        return false;
-    }
-
-    // Build nested structure: landlords -> properties -> units
-    landlordsJson = Json::Value(Json::arrayValue);
-    
-    for(const auto &landlord : landlordsArray) {
-        Json::Value ll(Json::objectValue);
-        ll["landlord_id"] = landlord["landlord_id"];
-        ll["name"] = landlord["name"];
-        
-        // Build contact object
-        Json::Value contact(Json::objectValue);
-        contact["email"] = landlord.get("contact_email", "");
-        contact["phone"] = landlord.get("contact_phone", "");
-        ll["contact"] = contact;
-        
-        // Find properties for this landlord
-        Json::Value properties(Json::arrayValue);
-        for(const auto &property : propertiesArray) {
-            if(property["landlord_id"].asString() == landlord["landlord_id"].asString()) {
-                Json::Value prop(Json::objectValue);
-                prop["property_id"] = property["property_id"];
-                
-                // Build address object
-                Json::Value address(Json::objectValue);
-                address["street"] = property.get("street", "");
-                address["city"] = property.get("city", "");
-                address["province"] = property.get("province", "");
-                address["zip"] = property.get("zip", "");
-                prop["address"] = address;
-                
-                // Find units for this property
-                Json::Value unitDetails(Json::arrayValue);
-                for(const auto &unit : unitsArray) {
-                    if(unit["property_id"].asString() == property["property_id"].asString()) {
-                        Json::Value u(Json::objectValue);
-                        u["unit_number"] = unit.get("unit_number", "");
-                        u["bedrooms"] = unit.get("bedrooms", 0);
-                        u["bathrooms"] = unit.get("bathrooms", 0);
-                        u["rent"] = unit.get("rent", 0);
-                        unitDetails.append(u);
-                    }
-                }
-                prop["unit_details"] = unitDetails;
-                properties.append(prop);
+    readThrough<Catalog>("landlords", [](uint64_t generation, FetchCallback done) {
+        auto finish = [generation, done](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+            // Cache the result. A snapshot that is published also becomes the set of landlords
+            // the leaderboard ranks, before any request is handed it
+            if(ok && setCached("landlords", catalog, generation)) {
+                RatingStore::instance().syncLandlords(catalog);
             }
-        }
-        ll["properties"] = properties;
-        landlordsJson.append(ll);
-    }
-
-    // Cache the result
-    setCached("landlords", landlordsJson);
+            done(ok, catalog, err);
+        };
 
-    return true;
+        if(supabaseConfig().embeddedCatalog && !embeddedCatalogUnsupported) {
+            fetchCatalogEmbedded(finish);
+        } else {
+            fetchCatalogTables(finish);
+        }
+    }, cb);
 }
 
-bool getLandlordStats(int &landlordCount, int &propertyCount, int &unitCount, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    // Get landlord count
-    std::string landlordsUrl = baseUrl + "/rest/v1/landlords?select=landlord_id";
-    std::string landlordsBody;
-    curl_easy_setopt(curl, CURLOPT_URL, landlordsUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &landlordsBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    Json::Reader reader;
-    Json::Value landlordsJson;
-    if(res == CURLE_OK && reader.parse(landlordsBody, landlordsJson) && landlordsJson.isArray()) {
-        landlordCount = landlordsJson.size();
-    } else {
-        landlordCount = 0;
-    }
-
-    // Get property count
-    std::string propertiesUrl = baseUrl + "/rest/v1/properties?select=property_id";
-    std::string propertiesBody;
-    curl_easy_setopt(curl, CURLOPT_URL, propertiesUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &propertiesBody);
-    res = curl_easy_perform(curl);
-    
-    Json::Value propertiesJson;
-    if(res == CURLE_OK && reader.parse(propertiesBody, propertiesJson) && propertiesJson.isArray()) {
-        propertyCount = propertiesJson.size();
-    } else {
-        propertyCount = 0;
-    }
-
-    // Get unit count
-    std::string unitsUrl = baseUrl + "/rest/v1/units?select=unit_id";
-    std::string unitsBody;
-    curl_easy_setopt(curl, CURLOPT_URL, unitsUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &unitsBody);
-    res = curl_easy_perform(curl);
-    
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    Json::Value unitsJson;
-    if(res == CURLE_OK && reader.parse(unitsBody, unitsJson) && unitsJson.isArray()) {
-        unitCount = unitsJson.size();
-    } else {
-        unitCount = 0;
-    }
-
-    return true;
+void getLandlordStats(JsonCallback cb) {
+    cb = onCallerLoop(std::move(cb));
+
+    readThrough<Json::Value>("stats", [](uint64_t generation, FetchCallback done) {
+        // Ask for exact row counts concurrently; HEAD requests, so no rows cross the wire
+        const std::vector<std::string> tableNames = {"landlords", "properties", "units"};
+        std::vector<SupabaseRequest> requests(3);
+        requests[0].path = "/rest/v1/landlords?select=landlord_id";
+        requests[1].path = "/rest/v1/properties?select=property_id";
+        requests[2].path = "/rest/v1/units?select=unit_id";
+        for(auto &request : requests) request.countOnly = true;
+        sendRequests(requests, [generation, done, tableNames](std::vector<SupabaseResponse> &&responses) {
+            // Every table must be counted; a missing count fails the whole answer rather than
+            // reading as zero
+            auto counts = std::make_shared<Json::Value>(Json::objectValue);
+            std::string err;
+            for(size_t i = 0; i < tableNames.size(); i++) {
+                const auto &resp = responses[i];
+                if(resp.ok && resp.count >= 0) {
+                    (*counts)[tableNames[i]] = static_cast<Json::Int64>(resp.count);
+                    continue;
+                }
+                if(!err.empty()) err += "; ";
+                err += tableNames[i] + " count failed: " + (resp.ok ? "no Content-Range in response" : resp.err);
+            }
+            if(!err.empty()) {
+                done(false, nullptr, err);
+                return;
+            }
+            setCached("stats", counts, generation);
+            done(true, counts, "");
+        });
+    }, [cb](bool ok, const std::shared_ptr<const Json::Value> &counts, const std::string &err) {
+        cb(ok, ok ? *counts : Json::Value(), err);
+    });
 }
 
-bool insertLandlordRequest(int &id,
-                           const std::string &landlord_name,
+void insertLandlordRequest(const std::string &landlord_name,
                            const std::string &landlord_email,
                            const std::string &landlord_phone,
                            const std::string &user_name,
                            const std::string &user_email,
                            const std::string &details,
                            const Json::Value &properties,
-                           std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/landlord_requests";
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-    headerStrings.emplace_back("Prefer: return=representation");
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
+                           JsonCallback cb) {
+    cb = onCallerLoop(std::move(cb));
 
     Json::Value payload(Json::objectValue);
     payload["landlord_name"] = landlord_name;
@@ -993,348 +1149,88 @@ bool insertLandlordRequest(int &id,
     payload["properties"] = properties;
     // id and created_at will be auto-generated by database
 
-    Json::StreamWriterBuilder writer;
-    const std::string body = Json::writeString(writer, payload);
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    // Parse response to get the generated id
-    Json::Value responseJson;
-    Json::Reader reader;
-    if(reader.parse(responseBody, responseJson) && responseJson.isArray() && responseJson.size() > 0) {
-        id = responseJson[0].get("id", 0).asInt();
-    } else {
-        err = "invalid response format from Supabase";
-        return false;
-    }
-
-    return true;
+    SupabaseRequest request;
+    request.method = "POST";
+    request.path = "/rest/v1/landlord_requests";
+    request.body = writeJson(payload);
+    request.returnRepresentation = true;
+    sendRequest(request, [cb](SupabaseResponse &&resp) {
+        if(!resp.ok) {
+            cb(false, Json::Value(), resp.err);
+            return;
+        }
+        // Parse response to get the generated id
+        Json::Value responseJson;
+        if(parseArray(resp, responseJson) && responseJson.size() > 0) {
+            cb(true, responseJson[0], "");
+        } else {
+            cb(false, Json::Value(), "invalid response format from Supabase");
+        }
+    });
 }
 
-bool getAllLandlordRequests(Json::Value &requestsJson, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/landlord_requests?order=created_at.desc";
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    Json::Reader reader;
-    if(!reader.parse(responseBody, requestsJson) || !requestsJson.isArray()) {
-        err = "invalid response format from Supabase";
-        return false;
-    }
-
-    return true;
+void getAllLandlordRequests(JsonCallback cb) {
+    SupabaseRequest request;
+    request.path = "/rest/v1/landlord_requests?order=created_at.desc";
+    sendRequest(request, completeWithArray(onCallerLoop(std::move(cb))));
 }
 
-bool deleteLandlordRequest(int id, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/landlord_requests?id=eq." + std::to_string(id);
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    return true;
+void deleteLandlordRequest(int id, DoneCallback cb) {
+    SupabaseRequest request;
+    request.method = "DELETE";
+    request.path = "/rest/v1/landlord_requests?id=eq." + std::to_string(id);
+    sendRequest(request, completeWith(onCallerLoop(std::move(cb))));
 }
 
-bool insertLandlord(const std::string &landlord_id,
+void insertLandlord(const std::string &landlord_id,
                     const std::string &name,
                     const std::string &contact_email,
                     const std::string &contact_phone,
                     const Json::Value &properties,
-                    std::string &err) {
-    // Invalidate landlords cache when a new landlord is added
-    invalidateCache("landlords");
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
+                    DoneCallback cb) {
+    auto state = std::make_shared<LandlordInsert>();
+    state->landlordId = landlord_id;
+    buildLandlordRows(*state, properties);
+    state->cb = [done = onCallerLoop(std::move(cb))](bool ok, const std::string &err) {
+        // Invalidate landlords and stats once the new landlord is stored, so the next
+        // fetch is sure to see it
+        if(ok) {
+            invalidateCache("landlords");
+            invalidateCache("stats");
+        }
+        done(ok, err);
+    };
 
     // Insert landlord
-    std::string landlordUrl = baseUrl + "/rest/v1/landlords";
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-    headerStrings.emplace_back("Prefer: return=representation");
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
     Json::Value landlordPayload(Json::objectValue);
     landlordPayload["landlord_id"] = landlord_id;
     landlordPayload["name"] = name;
     landlordPayload["contact_email"] = contact_email;
     landlordPayload["contact_phone"] = contact_phone;
 
-    Json::StreamWriterBuilder writer;
-    std::string landlordBody = Json::writeString(writer, landlordPayload);
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, landlordUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, landlordBody.c_str());
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    // Insert properties and units
-    bool allPropertiesInserted = true;
-    std::string propertyErrors;
-    for(const auto &prop : properties) {
-        std::string propertyId = prop["property_id"].asString();
-        std::string street = prop["address"]["street"].asString();
-        std::string city = prop["address"]["city"].asString();
-        std::string province = prop["address"].get("province", prop["address"].get("state", "")).asString();
-        std::string zip = prop["address"]["zip"].asString();
-
-        // Insert property
-        std::string propertyUrl = baseUrl + "/rest/v1/properties";
-        Json::Value propPayload(Json::objectValue);
-        propPayload["property_id"] = propertyId;
-        propPayload["landlord_id"] = landlord_id;
-        propPayload["street"] = street;
-        propPayload["city"] = city;
-        propPayload["province"] = province;
-        propPayload["zip"] = zip;
-
-        std::string propBody = Json::writeString(writer, propPayload);
-        curl_easy_setopt(curl, CURLOPT_URL, propertyUrl.c_str());
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, propBody.c_str());
-        responseBody.clear();
-        res = curl_easy_perform(curl);
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-        if(res != CURLE_OK || (httpCode < 200 || httpCode >= 300)) {
-            allPropertiesInserted = false;
-            propertyErrors += "Property " + propertyId + " failed; ";
-            continue; // Skip units for this property if property insert failed
-        }
-
-        // Insert units
-        const auto &units = prop["unit_details"];
-        for(const auto &unit : units) {
-            std::string unitUrl = baseUrl + "/rest/v1/units";
-            Json::Value unitPayload(Json::objectValue);
-            unitPayload["property_id"] = propertyId;
-            unitPayload["unit_number"] = unit.get("unit_number", "").asString();
-            unitPayload["bedrooms"] = unit.get("bedrooms", 0).asInt();
-            unitPayload["bathrooms"] = unit.get("bathrooms", 0).asDouble();
-            unitPayload["rent"] = unit.get("rent", 0).asInt();
-
-            std::string unitBody = Json::writeString(writer, unitPayload);
-            curl_easy_setopt(curl, CURLOPT_URL, unitUrl.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, unitBody.c_str());
-            responseBody.clear();
-            res = curl_easy_perform(curl);
-            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-            if(res != CURLE_OK || (httpCode < 200 || httpCode >= 300)) {
-                propertyErrors += "Unit in " + propertyId + " failed; ";
-            }
+    SupabaseRequest request;
+    request.method = "POST";
+    request.path = "/rest/v1/landlords";
+    request.body = writeJson(landlordPayload);
+    sendRequest(request, [state](SupabaseResponse &&resp) {
+        if(!resp.ok) {
+            state->cb(false, resp.err);
+            return;
         }
-    }
-
-    // If some properties/units failed, log warning but don't fail the whole operation
-    if(!allPropertiesInserted) {
-        err = "Landlord created but some properties/units failed: " + propertyErrors;
-        // Don't return false - landlord was created successfully
-    }
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    return true;
+        // Insert properties and units; any failure from here on rolls the landlord back
+        insertLandlordProperties(state);
+    });
 }
 
-bool insertReportedReview(const std::string &id,
+void insertReportedReview(const std::string &id,
                           const std::string &review_id,
                           const std::string &title,
                           const std::string &review,
                           const std::string &reason,
                           const std::string &reported_by,
                           const std::string &created_at,
-                          std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/reported_reviews";
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-    headerStrings.emplace_back("Prefer: return=representation");
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
+                          DoneCallback cb) {
+    cb = onCallerLoop(std::move(cb));
 
     Json::Value payload(Json::objectValue);
     payload["id"] = id;
@@ -1346,221 +1242,66 @@ bool insertReportedReview(const std::string &id,
     payload["created_at"] = created_at;
     payload["status"] = "pending";
 
-    Json::StreamWriterBuilder writer;
-    const std::string body = Json::writeString(writer, payload);
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    return true;
+    SupabaseRequest request;
+    request.method = "POST";
+    request.path = "/rest/v1/reported_reviews";
+    request.body = writeJson(payload);
+    request.returnRepresentation = true;
+    sendRequest(request, completeWith(cb));
 }
 
-bool getAllReportedReviews(Json::Value &reportsJson, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/reported_reviews?order=created_at.desc";
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    Json::Reader reader;
-    if(!reader.parse(responseBody, reportsJson) || !reportsJson.isArray()) {
-        err = "invalid response format from Supabase";
-        return false;
-    }
-
-    return true;
+void getAllReportedReviews(JsonCallback cb) {
+    SupabaseRequest request;
+    request.path = "/rest/v1/reported_reviews?order=created_at.desc";
+    sendRequest(request, completeWithArray(onCallerLoop(std::move(cb))));
 }
 
-bool deleteReportedReview(const std::string &id, std::string &err) {
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/reported_reviews?id=eq." + id;
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
-
-    return true;
+void deleteReportedReview(const std::string &id, DoneCallback cb) {
+    SupabaseRequest request;
+    request.method = "DELETE";
+    request.path = "/rest/v1/reported_reviews?id=eq." + id;
+    sendRequest(request, completeWith(onCallerLoop(std::move(cb))));
 }
 
-bool deleteReview(const std::string &id, std::string &err) {
-    // Invalidate reviews cache when a review is deleted
-    invalidateCache("reviews");
-    std::string baseUrl;
-    std::string serviceRoleKey;
-    if(!getSupabaseConfig(baseUrl, serviceRoleKey)) {
-        err = "Supabase not configured (SUPABASE_URL and SUPABASE_SERVICE_ROLE_KEY required)";
-        return false;
-    }
-
-    if(!ensureCurlInit(err)) {
-        return false;
-    }
-
-    std::string url = baseUrl + "/rest/v1/reviews?id=eq." + id;
-
-    CURL *curl = curl_easy_init();
-    if(!curl) {
-        err = "failed to construct supabase client";
-        return false;
-    }
-
-    std::vector<std::string> headerStrings;
-    headerStrings.emplace_back("Content-Type: application/json");
-    headerStrings.emplace_back("apikey: " + serviceRoleKey);
-    headerStrings.emplace_back("Authorization: Bearer " + serviceRoleKey);
-
-    struct curl_slist *headers = nullptr;
-    for(const auto &h : headerStrings) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    std::string responseBody;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeToString);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
-
-    CURLcode res = curl_easy_perform(curl);
-    if(res != CURLE_OK) {
-        err = curl_easy_strerror(res);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        return false;
-    }
-
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if(httpCode < 200 || httpCode >= 300) {
-        err = "supabase returned HTTP " + std::to_string(httpCode) + ": " + responseBody;
-        return false;
-    }
+void deleteReview(const std::string &id, JsonCallback cb) {
+    SupabaseRequest request;
+    request.method = "DELETE";
+    request.path = "/rest/v1/reviews?id=eq." + id + "&select=id,landlord_id,rating";
+    request.returnRepresentation = true;
+    sendRequest(request, completeWithArray(onCallerLoop(std::move(cb))));
+}
 
-    return true;
+void getConnectionStats(Json::Value &stats) {
+    const auto &config = supabaseConfig();
+    auto &loop = TransferLoop::instance();
+    auto &pool = handlePool();
+
+    uint64_t transfers = loop.transfers_;
+    uint64_t reused = loop.reusedConnections_;
+
+    Json::Value poolStats(Json::objectValue);
+    poolStats["pool_size"] = static_cast<Json::Int64>(config.poolSize);
+    poolStats["idle_timeout_seconds"] = static_cast<Json::Int64>(config.idleTimeoutSeconds);
+    poolStats["idle_handles"] = static_cast<Json::UInt64>(pool.idleCount());
+    poolStats["in_flight"] = static_cast<Json::UInt64>(loop.inFlight_);
+    poolStats["handles_created"] = static_cast<Json::UInt64>(pool.handlesCreated_);
+    poolStats["handles_reused"] = static_cast<Json::UInt64>(pool.handlesReused_);
+    poolStats["transfers"] = static_cast<Json::UInt64>(transfers);
+    poolStats["connections_reused"] = static_cast<Json::UInt64>(reused);
+    poolStats["connection_reuse_ratio"] = transfers > 0 ? static_cast<double>(reused) / transfers : 0.0;
+
+    Json::Value cacheStats(Json::objectValue);
+    cacheStats["originating_fetches"] = static_cast<Json::UInt64>(originatingFetches_);
+    cacheStats["coalesced_fetches"] = static_cast<Json::UInt64>(coalescedFetches_);
+    cacheStats["stale_served"] = static_cast<Json::UInt64>(staleServed_);
+    cacheStats["stale_on_error"] = static_cast<Json::UInt64>(staleOnError_);
+    cacheStats["soft_ttl_seconds"] = static_cast<Json::Int64>(config.cacheSoftTtlSeconds);
+    cacheStats["hard_ttl_seconds"] = static_cast<Json::Int64>(config.cacheHardTtlSeconds);
+    cacheStats["stale_if_error_seconds"] = static_cast<Json::Int64>(config.cacheStaleIfErrorSeconds);
+
+    stats = Json::Value(Json::objectValue);
+    stats["pool"] = poolStats;
+    stats["cache"] = cacheStats;
 }
 
 }
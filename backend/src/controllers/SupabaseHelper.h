@@ -1,105 +1,128 @@
 #pragma once
+#include <functional>
+#include <memory>
 #include <string>
 
 namespace Json {
     class Value;
 }
 
+class Catalog;
+class ReviewSet;
+
+/*
+    Every SupabaseHelper call is asynchronous. Requests are queued on a background
+    curl-multi transfer thread and the callback is invoked once the response arrives,
+    so Drogon's event loop is never blocked on a Supabase round trip.
+
+    Callbacks run on the Drogon event loop that issued the call (or directly on the
+    transfer thread when the call did not come from an event loop).
+*/
+
 namespace SupabaseHelper {
+    // ok is true on success; err describes the failure otherwise
+    using DoneCallback = std::function<void(bool ok, const std::string &err)>;
+    // value carries the boolean result of the query when ok is true
+    using FlagCallback = std::function<void(bool ok, bool value, const std::string &err)>;
+    // data carries the parsed JSON result when ok is true
+    using JsonCallback = std::function<void(bool ok, const Json::Value &data, const std::string &err)>;
+    // catalog is the shared, read-only landlord catalog when ok is true (nullptr otherwise)
+    using CatalogCallback = std::function<void(bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err)>;
+    // reviews holds the rating of every review when ok is true (nullptr otherwise)
+    using ReviewsCallback = std::function<void(bool ok, const std::shared_ptr<const ReviewSet> &reviews, const std::string &err)>;
+
     // Check if user exists in Supabase database
-    // Returns true on success, false on error
-    // Sets exists to true if user found, false otherwise
-    bool checkUserExists(const std::string &email, bool &exists, std::string &err);
+    // value is true if user found, false otherwise
+    void checkUserExists(const std::string &email, FlagCallback cb);
 
     // Insert user into Supabase database
-    // Returns true on success, false on error
-    bool insertUser(const std::string &email,
+    void insertUser(const std::string &email,
                     const std::string &name,
                     const std::string &password_plain,
                     const std::string &password_hashed,
                     int admin,
-                    std::string &err);
+                    DoneCallback cb);
 
     // Get user admin status from Supabase database
-    // Returns true on success, false on error
-    // Sets isAdmin to true if user is admin, false otherwise
-    bool getUserAdminStatus(const std::string &email, bool &isAdmin, std::string &err);
+    // value is true if user is admin, false otherwise
+    void getUserAdminStatus(const std::string &email, FlagCallback cb);
 
     // Get user data from Supabase database
-    // Returns true on success, false on error
-    // Fills name and admin with user data if found
-    bool getUserData(const std::string &email, std::string &name, bool &isAdmin, std::string &err);
+    // data is the user object with name and admin fields; fails if user not found
+    void getUserData(const std::string &email, JsonCallback cb);
 
     // Get user password hash and plaintext (for login verification)
-    // Returns true on success, false on error
-    // Fills password_hashed and password_plain if found
-    bool getUserPasswordHash(const std::string &email, std::string &password_hashed, std::string &password_plain, std::string &name, int &admin, std::string &err);
+    // data is the user object with password_hashed, password_plain, name and admin
+    // fields; fails if user not found
+    void getUserPasswordHash(const std::string &email, JsonCallback cb);
 
     // Insert review into Supabase database
-    // Returns true on success, false on error
-    bool insertReview(const std::string &id,
-                     const std::string &landlord_id,
-                     int rating,
-                     const std::string &title,
-                     const std::string &review,
-                     const std::string &created_at,
-                     std::string &err);
+    void insertReview(const std::string &id,
+                      const std::string &landlord_id,
+                      int rating,
+                      const std::string &title,
+                      const std::string &review,
+                      const std::string &created_at,
+                      DoneCallback cb);
 
     // Get reviews for a landlord from Supabase database
-    // Returns true on success, false on error
-    // Fills reviewsJson with array of reviews
-    bool getReviewsForLandlord(const std::string &landlord_id, Json::Value &reviewsJson, std::string &err);
+    // data is the array of reviews
+    void getReviewsForLandlord(const std::string &landlord_id, JsonCallback cb);
 
-    // Get all reviews from Supabase database (for computing ratings)
-    // Returns true on success, false on error
-    // Fills reviewsJson with array of all reviews
-    bool getAllReviews(Json::Value &reviewsJson, std::string &err);
+    // Get the id, landlord and rating of all reviews from Supabase (for the rating
+    // aggregates); always fetched fresh, never cached
+    void getAllReviews(ReviewsCallback cb);
 
     // Get all landlords with their properties and units from Supabase
-    // Returns true on success, false on error
-    // Fills landlordsJson with array of landlords (with nested properties and units)
-    bool getAllLandlords(Json::Value &landlordsJson, std::string &err);
+    void getAllLandlords(CatalogCallback cb);
 
     // Get landlord statistics (counts of landlords, properties, units)
-    // Returns true on success, false on error
-    // Fills counts with the statistics
-    bool getLandlordStats(int &landlordCount, int &propertyCount, int &unitCount, std::string &err);
+    // data is an object with landlords, properties and units counts
+    void getLandlordStats(JsonCallback cb);
 
     // Landlord Requests functions
-    bool insertLandlordRequest(int &id,
-                               const std::string &landlord_name,
+    // data is the inserted request row (including the generated id)
+    void insertLandlordRequest(const std::string &landlord_name,
                                const std::string &landlord_email,
                                const std::string &landlord_phone,
                                const std::string &user_name,
                                const std::string &user_email,
                                const std::string &details,
                                const Json::Value &properties,
-                               std::string &err);
+                               JsonCallback cb);
 
-    bool getAllLandlordRequests(Json::Value &requestsJson, std::string &err);
+    void getAllLandlordRequests(JsonCallback cb);
 
-    bool deleteLandlordRequest(int id, std::string &err);
+    void deleteLandlordRequest(int id, DoneCallback cb);
 
-    bool insertLandlord(const std::string &landlord_id,
+    // Insert a landlord with its properties[].unit_details[] (three requests in total, one per
+    // table). If any part fails, the rows already stored are removed again and cb gets ok=false
+    void insertLandlord(const std::string &landlord_id,
                         const std::string &name,
                         const std::string &contact_email,
                         const std::string &contact_phone,
                         const Json::Value &properties,
-                        std::string &err);
+                        DoneCallback cb);
 
     // Reported Reviews functions
-    bool insertReportedReview(const std::string &id,
+    void insertReportedReview(const std::string &id,
                               const std::string &review_id,
                               const std::string &title,
                               const std::string &review,
                               const std::string &reason,
                               const std::string &reported_by,
                               const std::string &created_at,
-                              std::string &err);
+                              DoneCallback cb);
+
+    void getAllReportedReviews(JsonCallback cb);
 
-    bool getAllReportedReviews(Json::Value &reportsJson, std::string &err);
+    void deleteReportedReview(const std::string &id, DoneCallback cb);
 
-    bool deleteReportedReview(const std::string &id, std::string &err);
+    // data is the array of deleted rows (id, landlord_id, rating); empty if none matched
+    void deleteReview(const std::string &id, JsonCallback cb);
 
-    bool deleteReview(const std::string &id, std::string &err);
+    // Connection pool statistics (pool size, idle timeout, handle and connection reuse) and
+    // cache statistics (originating vs coalesced fetches on cache misses)
+    // Fills stats with an object; answered locally without contacting Supabase
+    void getConnectionStats(Json::Value &stats);
 }
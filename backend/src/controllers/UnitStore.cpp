@@ -0,0 +1,86 @@
+#include "UnitStore.h"
+#include "Catalog.h"
+#include "NameIndex.h"
+#include <algorithm>
+#include <cmath>
+
+uint32_t UnitStore::encode(std::vector<std::string> &names, std::unordered_map<std::string, uint32_t> &lookup,
+                           const std::string &name) {
+    auto inserted = lookup.emplace(NameIndex::fold(name), static_cast<uint32_t>(names.size()));
+    if(inserted.second) names.push_back(name);
+    return inserted.first->second;
+}
+
+uint32_t UnitStore::find(const std::unordered_map<std::string, uint32_t> &lookup, const std::string &name) {
+    auto it = lookup.find(NameIndex::fold(name));
+    return it == lookup.end() ? NONE : it->second;
+}
+
+uint32_t UnitStore::findCity(const std::string &name) const {
+    return find(cityLookup_, name);
+}
+
+uint32_t UnitStore::findProvince(const std::string &name) const {
+    return find(provinceLookup_, name);
+}
+
+void UnitStore::build(const Catalog &catalog) {
+    *this = UnitStore();
+    size_t count = catalog.units.size();
+    cityId.resize(count);
+    provinceId.resize(count);
+    bedrooms.resize(count);
+    bathroomTenths.resize(count);
+    rentCents.resize(count);
+    property.resize(count);
+    propertyLandlord.resize(catalog.properties.size());
+
+    auto clamp16 = [](int value) { return static_cast<uint16_t>(std::min(std::max(value, 0), 65535)); };
+    for(uint32_t l = 0; l < catalog.landlords.size(); l++) {
+        const Landlord &landlord = catalog.landlords[l];
+        for(uint32_t p = landlord.firstProperty; p < landlord.firstProperty + landlord.propertyCount; p++) {
+            const Property &prop = catalog.properties[p];
+            propertyLandlord[p] = l;
+            uint32_t city = encode(cities_, cityLookup_, prop.city);
+            uint32_t province = encode(provinces_, provinceLookup_, prop.province);
+            for(uint32_t u = prop.firstUnit; u < prop.firstUnit + prop.unitCount; u++) {
+                const Unit &unit = catalog.units[u];
+                cityId[u] = city;
+                provinceId[u] = province;
+                bedrooms[u] = clamp16(unit.bedrooms);
+                bathroomTenths[u] = static_cast<uint16_t>(std::min(std::max(std::round(unit.bathrooms * 10), 0.0), 65535.0));
+                rentCents[u] = static_cast<uint32_t>(std::min(std::max(std::round(unit.rent * 100), 0.0), 4294967295.0));
+                property[u] = p;
+            }
+        }
+    }
+}
+
+std::vector<UnitStore::CityStats> UnitStore::cityStats() const {
+    std::vector<CityStats> stats(cities_.size());
+    for(uint32_t u = 0; u < size(); u++) {
+        CityStats &city = stats[cityId[u]];
+        uint32_t rent = rentCents[u];
+        if(city.units == 0 || rent < city.minRentCents) city.minRentCents = rent;
+        if(city.units == 0 || rent > city.maxRentCents) city.maxRentCents = rent;
+        city.units++;
+        city.rentCentsSum += rent;
+    }
+    return stats;
+}
+
+size_t UnitStore::memoryBytes() const {
+    size_t bytes = sizeof(*this);
+    bytes += cityId.capacity() * sizeof(uint32_t) + provinceId.capacity() * sizeof(uint32_t);
+    bytes += bedrooms.capacity() * sizeof(uint16_t) + bathroomTenths.capacity() * sizeof(uint16_t);
+    bytes += rentCents.capacity() * sizeof(uint32_t) + property.capacity() * sizeof(uint32_t);
+    bytes += propertyLandlord.capacity() * sizeof(uint32_t);
+    for(const auto *names : {&cities_, &provinces_}) {
+        for(const auto &name : *names) bytes += sizeof(std::string) + name.size();
+    }
+    // Lookup entries: the folded key plus roughly a node and a bucket each
+    for(const auto *lookup : {&cityLookup_, &provinceLookup_}) {
+        for(const auto &entry : *lookup) bytes += sizeof(entry) + entry.first.size() + 2 * sizeof(void *);
+    }
+    return bytes;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Catalog;
+
+/*
+    What is the UnitStore?
+    The units of one catalog snapshot in columns: unit u is cityId[u], provinceId[u],
+    bedrooms[u], bathroomTenths[u], rentCents[u] and property[u], with the same positions as
+    Catalog::units. City and province names are dictionary encoded, so each distinct name
+    is stored once however many units share it. Range filters over rent and bedrooms are
+    answered from FacetIndex's bitmaps, which check edge rent buckets against rentCents.
+*/
+class UnitStore {
+public:
+    struct CityStats {
+        uint32_t units = 0;
+        uint64_t rentCentsSum = 0;
+        uint32_t minRentCents = 0;
+        uint32_t maxRentCents = 0;
+    };
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    std::vector<uint32_t> cityId;
+    std::vector<uint32_t> provinceId;
+    std::vector<uint16_t> bedrooms;
+    std::vector<uint16_t> bathroomTenths;       // 1.5 bathrooms is 15
+    std::vector<uint32_t> rentCents;
+    std::vector<uint32_t> property;             // position in Catalog::properties
+    std::vector<uint32_t> propertyLandlord;     // by property: position in Catalog::landlords
+
+    void build(const Catalog &catalog);
+
+    uint32_t size() const { return static_cast<uint32_t>(rentCents.size()); }
+
+    // Dictionaries; names keep the spelling of the first unit seen with them
+    const std::vector<std::string> &cities() const { return cities_; }
+    const std::vector<std::string> &provinces() const { return provinces_; }
+
+    // Dictionary id of a name, ignoring case, or NONE
+    uint32_t findCity(const std::string &name) const;
+    uint32_t findProvince(const std::string &name) const;
+
+    // Unit count and rent figures of every city, indexed by city id
+    std::vector<CityStats> cityStats() const;
+
+    // Approximate bytes held by the columns and dictionaries
+    size_t memoryBytes() const;
+
+private:
+    static uint32_t encode(std::vector<std::string> &names, std::unordered_map<std::string, uint32_t> &lookup,
+                           const std::string &name);
+    static uint32_t find(const std::unordered_map<std::string, uint32_t> &lookup, const std::string &name);
+
+    std::vector<std::string> cities_;
+    std::unordered_map<std::string, uint32_t> cityLookup_;      // folded name -> id
+    std::vector<std::string> provinces_;
+    std::unordered_map<std::string, uint32_t> provinceLookup_;
+};
@@ -14,26 +14,28 @@ void UserCtrl::me(const drogon::HttpRequestPtr &req, std::function<void (const d
     }
 
     // Load user data from Supabase database
-    std::string name;
-    bool isAdmin = false;
-    std::string err;
-    if(!SupabaseHelper::getUserData(email, name, isAdmin, err)) {
-        LOG_ERROR << "Failed to get user data for " << email << ": " << err;
-        auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
-        resp->setStatusCode(drogon::k500InternalServerError);
-        (*resp->getJsonObject())["error"] = "failed to load user data";
-        cb(resp);
-        return;
-    }
+    SupabaseHelper::getUserData(email, [email, cb = std::move(cb)](bool ok, const Json::Value &user, const std::string &err) {
+        if(!ok) {
+            LOG_ERROR << "Failed to get user data for " << email << ": " << err;
+            auto resp = drogon::HttpResponse::newHttpJsonResponse(Json::Value(Json::objectValue));
+            resp->setStatusCode(drogon::k500InternalServerError);
+            (*resp->getJsonObject())["error"] = "failed to load user data";
+            cb(resp);
+            return;
+        }
+
+        std::string name = user.get("name", "").asString();
+        bool isAdmin = user.get("admin", 0).asInt() == 1;
 
-    // Fallback if name is empty
-    if(name.empty()) name = "User";
+        // Fallback if name is empty
+        if(name.empty()) name = "User";
 
-    Json::Value me(Json::objectValue);
-    me["email"] = email;
-    me["name"] = name;
-    me["admin"] = isAdmin ? 1 : 0;
+        Json::Value me(Json::objectValue);
+        me["email"] = email;
+        me["name"] = name;
+        me["admin"] = isAdmin ? 1 : 0;
 
-    auto resp = drogon::HttpResponse::newHttpJsonResponse(me);
-    cb(resp);
-}
+        auto resp = drogon::HttpResponse::newHttpJsonResponse(me);
+        cb(resp);
+    });
+}
\ No newline at end of file
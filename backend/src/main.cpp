@@ -1,6 +1,7 @@
 #include <drogon/drogon.h>
 #include <sodium.h>
 
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 #include <string>
@@ -10,6 +11,7 @@
 #include "controllers/ReviewCtrl.h"
 #include "controllers/UserCtrl.h"
 #include "controllers/AdminCtrl.h"
+#include "controllers/RatingStore.h"
 
 static std::string resolveDataPath(const std::string& relative) {
   namespace fs = std::filesystem;
@@ -184,6 +186,42 @@ int main() {
       },
       {drogon::Get});
 
+  drogon::app().registerHandler(
+      "/api/landlords/suggest",
+      [landlord](const drogon::HttpRequestPtr& req,
+                 std::function<void(const drogon::HttpResponsePtr&)>&& cb) {
+        landlord->suggest(req, std::move(cb));
+      },
+      {drogon::Get});
+
+  // Registered after the fixed /api/landlords/ paths so they take precedence
+  drogon::app().registerHandler(
+      "/api/landlords/{id}",
+      [landlord](const drogon::HttpRequestPtr& req,
+                 std::function<void(const drogon::HttpResponsePtr&)>&& cb,
+                 const std::string& id) {
+        landlord->detail(req, std::move(cb), id);
+      },
+      {drogon::Get});
+
+  // -----------------------------
+  // Properties
+  // -----------------------------
+  drogon::app().registerHandler(
+      "/api/properties/search",
+      [landlord](const drogon::HttpRequestPtr& req,
+                 std::function<void(const drogon::HttpResponsePtr&)>&& cb) {
+        landlord->searchProperties(req, std::move(cb));
+      },
+      {drogon::Get});
+  drogon::app().registerHandler(
+      "/api/properties/stats",
+      [landlord](const drogon::HttpRequestPtr& req,
+                 std::function<void(const drogon::HttpResponsePtr&)>&& cb) {
+        landlord->propertyStats(req, std::move(cb));
+      },
+      {drogon::Get});
+
   // -----------------------------
   // Reviews
   // -----------------------------
@@ -270,6 +308,26 @@ int main() {
       },
       {drogon::Post});
 
+  // -----------------------------
+  // Admin: Supabase client statistics
+  // -----------------------------
+  drogon::app().registerHandler(
+      "/api/admin/supabase/stats",
+      [admin](const drogon::HttpRequestPtr& req,
+              std::function<void(const drogon::HttpResponsePtr&)>&& cb) {
+        admin->supabaseStats(req, std::move(cb));
+      },
+      {drogon::Get});
+
+  // -----------------------------
+  // Rating aggregates: load them now, then reconcile with Supabase
+  // every RATINGS_RECONCILE_SECONDS (default 300)
+  // -----------------------------
+  const char* reconcileEnv = std::getenv("RATINGS_RECONCILE_SECONDS");
+  double reconcileSeconds = reconcileEnv ? std::atof(reconcileEnv) : 0;
+  if (reconcileSeconds <= 0) reconcileSeconds = 300;
+  RatingStore::instance().start(drogon::app().getLoop(), reconcileSeconds);
+
   // -----------------------------
   // Run server
   // -----------------------------
@@ -0,0 +1,128 @@
+#include "controllers/Bitmap.h"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+    // Chunk populations on both sides of the array/bitset switch (4096 values)
+    const uint32_t densities[] = {0, 1, 100, 4095, 4096, 4097, 30000, 65536};
+
+    // Sorted distinct values: in each of a few chunks, count values drawn from that chunk
+    std::vector<uint32_t> randomValues(std::mt19937 &rng, const std::vector<uint16_t> &keys) {
+        std::set<uint32_t> values;
+        for(uint16_t key : keys) {
+            uint32_t count = densities[rng() % 8];
+            uint32_t high = static_cast<uint32_t>(key) << 16;
+            if(count == 65536) {
+                for(uint32_t low = 0; low < 65536; low++) values.insert(high | low);
+            } else {
+                for(uint32_t added = 0; added < count;) added += values.insert(high | (rng() & 0xFFFF)).second;
+            }
+        }
+        return std::vector<uint32_t>(values.begin(), values.end());
+    }
+
+    Bitmap toBitmap(const std::vector<uint32_t> &values) {
+        Bitmap bitmap;
+        for(uint32_t value : values) bitmap.append(value);
+        return bitmap;
+    }
+
+    std::vector<uint16_t> randomKeys(std::mt19937 &rng) {
+        std::vector<uint16_t> keys;
+        for(uint16_t key : {uint16_t(0), uint16_t(1), uint16_t(2), uint16_t(7), uint16_t(65535)}) {
+            if(rng() % 3) keys.push_back(key);
+        }
+        return keys;
+    }
+}
+
+TEST_CASE("Bitmap AND, OR and counts match sorted vectors", "[bitmap]") {
+    std::mt19937 rng(22);
+    for(int round = 0; round < 60; round++) {
+        std::vector<uint32_t> a = randomValues(rng, randomKeys(rng));
+        std::vector<uint32_t> b = randomValues(rng, randomKeys(rng));
+        Bitmap left = toBitmap(a);
+        Bitmap right = toBitmap(b);
+        REQUIRE(left.values() == a);
+        REQUIRE(left.cardinality() == a.size());
+        CHECK(left.empty() == a.empty());
+
+        std::vector<uint32_t> both, either;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(both));
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(either));
+        INFO(a.size() << " and " << b.size() << " values");
+        Bitmap intersection = left & right;
+        Bitmap unionOf = left | right;
+        REQUIRE(intersection.values() == both);
+        REQUIRE(intersection.cardinality() == both.size());
+        REQUIRE(intersection.empty() == both.empty());
+        REQUIRE(unionOf.values() == either);
+        REQUIRE(unionOf.cardinality() == either.size());
+        REQUIRE(left.andCardinality(right) == both.size());
+        REQUIRE(right.andCardinality(left) == both.size());
+
+        // Results are bitmaps like any other: combine them again
+        REQUIRE((unionOf & left).values() == a);
+        REQUIRE((intersection | left).values() == a);
+    }
+}
+
+TEST_CASE("Bitmap switches chunk representation at the array limit", "[bitmap]") {
+    // Dense chunks whose intersection is empty or just over the limit, and two sparse chunks
+    // whose union is just over it
+    std::vector<uint32_t> evens, odds, lowEvens;
+    for(uint32_t v = 0; v < 65536; v += 2) evens.push_back(v);
+    for(uint32_t v = 1; v < 65536; v += 2) odds.push_back(v);
+    for(uint32_t v = 0; v < 8194; v += 2) lowEvens.push_back(v);
+    std::vector<uint32_t> firstHalf(lowEvens.begin(), lowEvens.begin() + 2049);
+    std::vector<uint32_t> secondHalf(lowEvens.begin() + 2049, lowEvens.end());
+
+    CHECK((toBitmap(evens) & toBitmap(odds)).empty());
+    CHECK((toBitmap(evens) & toBitmap(lowEvens)).values() == lowEvens);
+    CHECK((toBitmap(firstHalf) | toBitmap(secondHalf)).values() == lowEvens);
+    CHECK((toBitmap(evens) | toBitmap(odds)).cardinality() == 65536);
+    CHECK(toBitmap(evens).andCardinality(toBitmap(lowEvens)) == lowEvens.size());
+
+    Bitmap none;
+    CHECK(none.empty());
+    CHECK(none.values().empty());
+    CHECK((none | toBitmap(odds)).values() == odds);
+    CHECK((toBitmap(odds) & none).empty());
+}
+
+TEST_CASE("Bitmap set operations over 100k units", "[.][benchmark][bitmap]") {
+    std::mt19937 rng(23);
+    const uint32_t units = 100000;
+    // A city with a third of the units and a bedroom count with a fifth, as a facet search ANDs
+    std::vector<uint32_t> city, bedrooms;
+    for(uint32_t u = 0; u < units; u++) {
+        if(rng() % 3 == 0) city.push_back(u);
+        if(rng() % 5 == 0) bedrooms.push_back(u);
+    }
+    Bitmap cityBitmap = toBitmap(city);
+    Bitmap bedroomBitmap = toBitmap(bedrooms);
+
+    BENCHMARK("std::set_intersection of sorted vectors") {
+        std::vector<uint32_t> both;
+        std::set_intersection(city.begin(), city.end(), bedrooms.begin(), bedrooms.end(), std::back_inserter(both));
+        return both.size();
+    };
+    BENCHMARK("Bitmap AND") {
+        return (cityBitmap & bedroomBitmap).cardinality();
+    };
+    BENCHMARK("Bitmap AND count") {
+        return cityBitmap.andCardinality(bedroomBitmap);
+    };
+    BENCHMARK("std::set_union of sorted vectors") {
+        std::vector<uint32_t> either;
+        std::set_union(city.begin(), city.end(), bedrooms.begin(), bedrooms.end(), std::back_inserter(either));
+        return either.size();
+    };
+    BENCHMARK("Bitmap OR") {
+        return (cityBitmap | bedroomBitmap).cardinality();
+    };
+}
@@ -0,0 +1,158 @@
+#include "controllers/CatalogBuilder.h"
+#include "controllers/IdInterner.h"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Rows of the three tables, shuffled the way Supabase may return them
+    struct Tables {
+        std::vector<Landlord> landlords;
+        std::vector<std::pair<std::string, Property>> properties;   // landlord_id, row
+        std::vector<std::pair<std::string, Unit>> units;             // property_id, row
+    };
+
+    Tables makeTables(const std::string &prefix, size_t landlordCount, std::mt19937 &rng) {
+        Tables tables;
+        for(size_t l = 0; l < landlordCount; l++) {
+            Landlord landlord;
+            landlord.landlordId = prefix + "LL" + std::to_string(l);
+            landlord.key = IdInterner::landlords().intern(landlord.landlordId);
+            landlord.name = "Landlord " + std::to_string(l);
+            tables.landlords.push_back(landlord);
+            for(uint32_t p = 0, properties = rng() % 4; p < properties; p++) {
+                Property property;
+                property.propertyId = landlord.landlordId + "_P" + std::to_string(p);
+                property.key = IdInterner::properties().intern(property.propertyId);
+                property.city = "City " + std::to_string(rng() % 10);
+                tables.properties.emplace_back(landlord.landlordId, property);
+                for(uint32_t u = 0, units = rng() % 4; u < units; u++) {
+                    Unit unit;
+                    unit.unitNumber = property.propertyId + "_U" + std::to_string(u);
+                    unit.bedrooms = static_cast<int>(rng() % 5);
+                    unit.rent = 500 + rng() % 3000;
+                    tables.units.emplace_back(property.propertyId, unit);
+                }
+            }
+        }
+        // Orphans: rows whose parent does not exist
+        Property orphanProperty;
+        orphanProperty.propertyId = prefix + "orphan_P";
+        orphanProperty.key = IdInterner::properties().intern(orphanProperty.propertyId);
+        tables.properties.emplace_back(prefix + "no_such_landlord", orphanProperty);
+        Unit orphanUnit;
+        orphanUnit.unitNumber = "orphan";
+        tables.units.emplace_back(prefix + "no_such_property", orphanUnit);
+
+        std::shuffle(tables.landlords.begin(), tables.landlords.end(), rng);
+        std::shuffle(tables.properties.begin(), tables.properties.end(), rng);
+        std::shuffle(tables.units.begin(), tables.units.end(), rng);
+        return tables;
+    }
+
+    void fill(CatalogBuilder &builder, const Tables &tables) {
+        builder.reserve(tables.landlords.size(), tables.properties.size(), tables.units.size());
+        for(auto landlord : tables.landlords) builder.addLandlord(std::move(landlord));
+        for(auto row : tables.properties) {
+            builder.addProperty(IdInterner::landlords().intern(row.first), std::move(row.second));
+        }
+        for(auto row : tables.units) {
+            builder.addUnit(IdInterner::properties().intern(row.first), std::move(row.second));
+        }
+    }
+
+    std::shared_ptr<Catalog> join(const Tables &tables) {
+        CatalogBuilder builder;
+        fill(builder, tables);
+        return builder.join();
+    }
+}
+
+TEST_CASE("CatalogBuilder joins tables like the nested loops it replaced", "[catalog]") {
+    std::mt19937 rng(4);
+    Tables tables = makeTables("join-", 300, rng);
+    auto catalog = join(tables);
+
+    // Reference: for every landlord, scan all properties, and for every property all units
+    std::vector<std::string> expected, actual;
+    for(const auto &landlord : tables.landlords) {
+        expected.push_back("L " + landlord.landlordId);
+        for(const auto &property : tables.properties) {
+            if(property.first != landlord.landlordId) continue;
+            expected.push_back("P " + property.second.propertyId);
+            for(const auto &unit : tables.units) {
+                if(unit.first == property.second.propertyId) expected.push_back("U " + unit.second.unitNumber);
+            }
+        }
+    }
+    for(const auto &landlord : catalog->landlords) {
+        actual.push_back("L " + landlord.landlordId);
+        for(uint32_t p = landlord.firstProperty; p < landlord.firstProperty + landlord.propertyCount; p++) {
+            const Property &property = catalog->properties[p];
+            actual.push_back("P " + property.propertyId);
+            for(uint32_t u = property.firstUnit; u < property.firstUnit + property.unitCount; u++) {
+                actual.push_back("U " + catalog->units[u].unitNumber);
+            }
+        }
+    }
+    CHECK(actual == expected);
+    CHECK(catalog->properties.size() == tables.properties.size() - 1);
+    CHECK(catalog->units.size() < tables.units.size());
+}
+
+TEST_CASE("CatalogBuilder handles empty tables", "[catalog]") {
+    CatalogBuilder builder;
+    auto catalog = builder.join();
+    CHECK(catalog->landlords.empty());
+    CHECK(catalog->properties.empty());
+    CHECK(catalog->units.empty());
+}
+
+TEST_CASE("Catalog finds properties by address", "[catalog]") {
+    CatalogBuilder builder;
+    Landlord landlord;
+    landlord.landlordId = "address-LL";
+    landlord.key = IdInterner::landlords().intern(landlord.landlordId);
+    const char *streets[] = {"12 Princess St", "400 King St W", "7 Princess Ave"};
+    for(int p = 0; p < 3; p++) {
+        Property property;
+        property.propertyId = "address-P" + std::to_string(p);
+        property.key = IdInterner::properties().intern(property.propertyId);
+        property.street = streets[p];
+        property.city = p == 1 ? "Toronto" : "Kingston";
+        property.province = "ON";
+        property.zip = p == 1 ? "M5V 1A1" : "K7L 2B2";
+        builder.addProperty(landlord.key, std::move(property));
+    }
+    builder.addLandlord(std::move(landlord));
+    auto catalog = builder.join();
+    catalog->index();
+
+    CHECK(catalog->searchAddresses("princess") == std::vector<uint32_t>{0, 2});
+    CHECK(catalog->searchAddresses("st, kingston") == std::vector<uint32_t>{0});
+    CHECK(catalog->searchAddresses("m5v") == std::vector<uint32_t>{1});
+    CHECK(catalog->searchAddresses("ON") == std::vector<uint32_t>{0, 1, 2});
+    CHECK(catalog->searchAddresses("Ottawa").empty());
+}
+
+TEST_CASE("Catalog refresh time by catalog size", "[.][benchmark][catalog]") {
+    std::mt19937 rng(9);
+    for(size_t landlords : {1000, 10000, 100000}) {
+        Tables tables = makeTables("bench" + std::to_string(landlords) + "-", landlords, rng);
+        std::string size = std::to_string(landlords) + " landlords";
+
+        // Rows are added before the clock starts, as the fetch does while reading responses
+        BENCHMARK_ADVANCED("join " + size)(Catch::Benchmark::Chronometer meter) {
+            std::vector<CatalogBuilder> builders(meter.runs());
+            for(auto &builder : builders) fill(builder, tables);
+            meter.measure([&](int run) { return builders[run].join(); });
+        };
+        BENCHMARK_ADVANCED("index " + size)(Catch::Benchmark::Chronometer meter) {
+            std::vector<std::shared_ptr<Catalog>> catalogs;
+            for(int run = 0; run < meter.runs(); run++) catalogs.push_back(join(tables));
+            meter.measure([&](int run) { catalogs[run]->index(); });
+        };
+    }
+}
@@ -0,0 +1,257 @@
+#include "controllers/CatalogBuilder.h"
+#include "controllers/CatalogReader.h"
+#include "controllers/IdInterner.h"
+#include "controllers/JsonStream.h"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Feed body to handler in chunks of the given size, as curl would
+    bool parse(const std::string &body, JsonSaxHandler &handler, size_t chunk) {
+        JsonStreamParser parser(handler);
+        for(size_t at = 0; at < body.size(); at += chunk) {
+            if(!parser.feed(body.data() + at, std::min(chunk, body.size() - at))) return false;
+        }
+        return parser.finish();
+    }
+
+    std::string write(const Json::Value &value) {
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        return Json::writeString(writer, value);
+    }
+
+    std::string catalogJson(const Catalog &catalog) {
+        Json::Value landlords(Json::arrayValue);
+        for(const auto &landlord : catalog.landlords) landlords.append(catalog.toJson(landlord));
+        return write(landlords);
+    }
+
+    // The Json::Value readers the SAX readers replaced, kept as the reference
+    std::string textField(const Json::Value &row, const char *name) {
+        const Json::Value &value = row[name];
+        return value.isNull() ? std::string() : value.asString();
+    }
+
+    double numberField(const Json::Value &row, const char *name) {
+        const Json::Value &value = row[name];
+        if(value.isNumeric()) return value.asDouble();
+        if(value.isString()) return std::strtod(value.asCString(), nullptr);
+        return 0;
+    }
+
+    Landlord domLandlord(const Json::Value &row) {
+        Landlord landlord;
+        landlord.landlordId = textField(row, "landlord_id");
+        landlord.key = IdInterner::landlords().intern(landlord.landlordId);
+        landlord.name = textField(row, "name");
+        landlord.email = textField(row, "contact_email");
+        landlord.phone = textField(row, "contact_phone");
+        return landlord;
+    }
+
+    Property domProperty(const Json::Value &row) {
+        Property property;
+        property.propertyId = textField(row, "property_id");
+        property.key = IdInterner::properties().intern(property.propertyId);
+        property.street = textField(row, "street");
+        property.city = textField(row, "city");
+        property.province = textField(row, "province");
+        property.zip = textField(row, "zip");
+        return property;
+    }
+
+    Unit domUnit(const Json::Value &row) {
+        Unit unit;
+        unit.unitNumber = textField(row, "unit_number");
+        unit.bedrooms = static_cast<int>(numberField(row, "bedrooms"));
+        unit.bathrooms = numberField(row, "bathrooms");
+        unit.rent = numberField(row, "rent");
+        return unit;
+    }
+
+    std::shared_ptr<Catalog> domEmbedded(const std::string &body) {
+        JsonValueBuilder dom;
+        REQUIRE(parse(body, dom, body.size()));
+        CatalogBuilder builder;
+        for(const auto &landlordRow : dom.result()) {
+            Landlord landlord = domLandlord(landlordRow);
+            for(const auto &propertyRow : landlordRow["properties"]) {
+                Property property = domProperty(propertyRow);
+                for(const auto &unitRow : propertyRow["units"]) builder.addUnit(property.key, domUnit(unitRow));
+                builder.addProperty(landlord.key, std::move(property));
+            }
+            builder.addLandlord(std::move(landlord));
+        }
+        return builder.join();
+    }
+
+    // An embedded catalog response with the awkward cases PostgREST can send: null
+    // columns, numbers as strings, columns the catalog does not keep, nested values
+    Json::Value embeddedRows(const std::string &prefix, size_t landlordCount, std::mt19937 &rng) {
+        Json::Value landlords(Json::arrayValue);
+        for(size_t l = 0; l < landlordCount; l++) {
+            Json::Value landlord;
+            landlord["landlord_id"] = prefix + std::to_string(l);
+            landlord["name"] = "Landlord \"" + std::to_string(l) + "\" \\ \xc3\xa9";
+            landlord["contact_email"] = rng() % 3 ? Json::Value("ll" + std::to_string(l) + "@example.com") : Json::Value();
+            landlord["contact_phone"] = Json::Value();
+            landlord["metadata"]["tags"].append("x");
+            landlord["metadata"]["units"] = Json::Value(Json::arrayValue);
+            landlord["properties"] = Json::Value(Json::arrayValue);
+            for(uint32_t p = 0, properties = rng() % 4; p < properties; p++) {
+                Json::Value property;
+                property["property_id"] = prefix + std::to_string(l) + "_P" + std::to_string(p);
+                property["street"] = std::to_string(p) + " Main St";
+                property["city"] = "City " + std::to_string(rng() % 10);
+                property["province"] = "ON";
+                property["zip"] = Json::Value();
+                property["units"] = Json::Value(Json::arrayValue);
+                for(uint32_t u = 0, units = rng() % 4; u < units; u++) {
+                    Json::Value unit;
+                    unit["unit_number"] = rng() % 2 ? Json::Value(std::to_string(u)) : Json::Value(u);
+                    unit["bedrooms"] = rng() % 2 ? Json::Value(rng() % 5) : Json::Value(std::to_string(rng() % 5));
+                    unit["bathrooms"] = rng() % 2 ? Json::Value(1) : rng() % 2 ? Json::Value(1.5) : Json::Value();
+                    unit["rent"] = rng() % 2 ? Json::Value(500 + rng() % 3000 + 0.5) : Json::Value("1450.25");
+                    unit["amenities"][0]["name"] = "parking";
+                    property["units"].append(unit);
+                }
+                landlord["properties"].append(property);
+            }
+            landlords.append(landlord);
+        }
+        return landlords;
+    }
+}
+
+TEST_CASE("CatalogReader reads the embedded catalog like the Json::Value readers", "[catalog][json]") {
+    std::mt19937 rng(6);
+    std::string body = write(embeddedRows("embedded-", 200, rng));
+    std::string expected = catalogJson(*domEmbedded(body));
+
+    for(size_t chunk : {size_t(1), size_t(7), size_t(4096), body.size()}) {
+        CatalogBuilder builder;
+        CatalogReader reader(builder, CatalogReader::Table::Embedded);
+        REQUIRE(parse(body, reader, chunk));
+        CHECK(reader.valid());
+        auto catalog = builder.join();
+        CHECK(catalogJson(*catalog) == expected);
+        CHECK(catalog->jsonBytes() == expected.size());
+    }
+}
+
+TEST_CASE("CatalogReader does not depend on column order", "[catalog][json]") {
+    // Nested rows before the id columns of their parents
+    std::string body = R"([{"properties":[{"units":[{"rent":"900","bathrooms":1.5,"unit_number":"1"}],"property_id":"order-P1"},)"
+                       R"({"units":[],"property_id":"order-P2","city":"Kingston"}],"name":"Late Id","landlord_id":"order-L1"}])";
+    CatalogBuilder builder;
+    CatalogReader reader(builder, CatalogReader::Table::Embedded);
+    REQUIRE(parse(body, reader, body.size()));
+    auto catalog = builder.join();
+
+    REQUIRE(catalog->landlords.size() == 1);
+    CHECK(catalog->landlords[0].landlordId == "order-L1");
+    CHECK(catalog->landlords[0].name == "Late Id");
+    REQUIRE(catalog->properties.size() == 2);
+    CHECK(catalog->properties[0].propertyId == "order-P1");
+    CHECK(catalog->properties[1].city == "Kingston");
+    REQUIRE(catalog->units.size() == 1);
+    CHECK(catalog->properties[0].unitCount == 1);
+    CHECK(catalog->units[0].rent == 900);
+    CHECK(catalog->units[0].bathrooms == 1.5);
+    CHECK(Catalog::toJson(catalog->units[0])["bathrooms"].asDouble() == 1.5);
+}
+
+TEST_CASE("CatalogReader reads the three table scans", "[catalog][json]") {
+    std::mt19937 rng(7);
+    Json::Value embedded = embeddedRows("tables-", 150, rng);
+    std::string expected = catalogJson(*domEmbedded(write(embedded)));
+
+    // Split the embedded rows into table rows carrying their parent's id
+    Json::Value landlords(Json::arrayValue), properties(Json::arrayValue), units(Json::arrayValue);
+    for(auto landlord : embedded) {
+        for(auto property : landlord["properties"]) {
+            for(auto unit : property["units"]) {
+                unit["property_id"] = property["property_id"];
+                units.append(unit);
+            }
+            property.removeMember("units");
+            property["landlord_id"] = landlord["landlord_id"];
+            properties.append(property);
+        }
+        landlord.removeMember("properties");
+        landlords.append(landlord);
+    }
+
+    CatalogBuilder builder;
+    CatalogReader landlordReader(builder, CatalogReader::Table::Landlords);
+    CatalogReader propertyReader(builder, CatalogReader::Table::Properties);
+    CatalogReader unitReader(builder, CatalogReader::Table::Units);
+    // Units first: the join must not depend on which table arrives first
+    REQUIRE(parse(write(units), unitReader, 512));
+    REQUIRE(parse(write(landlords), landlordReader, 512));
+    REQUIRE(parse(write(properties), propertyReader, 512));
+    CHECK(catalogJson(*builder.join()) == expected);
+}
+
+TEST_CASE("ReviewReader reads review ids, landlords and ratings", "[catalog][json]") {
+    std::string body = R"([{"id":17,"landlord_id":"reviews-L1","rating":4,"comment":{"text":"ok"}},)"
+                       R"({"id":"r2","landlord_id":"reviews-L2","rating":"5"},)"
+                       R"({"id":"r3","landlord_id":"reviews-L1","rating":null},)"
+                       R"({"landlord_id":"reviews-L2","rating":9}])";
+    ReviewSet reviews;
+    ReviewReader reader(reviews);
+    REQUIRE(parse(body, reader, 3));
+    CHECK(reader.valid());
+
+    REQUIRE(reviews.size() == 4);
+    CHECK(reviews.reviewIds == std::vector<std::string>{"17", "r2", "r3", ""});
+    CHECK(reviews.landlordKeys[0] == IdInterner::landlords().intern("reviews-L1"));
+    CHECK(reviews.landlordKeys[1] == IdInterner::landlords().intern("reviews-L2"));
+    CHECK(reviews.ratings == std::vector<uint8_t>{4, 5, 0, 0});
+}
+
+TEST_CASE("Row readers reject a response that is not an array", "[catalog][json]") {
+    // What PostgREST sends back with an error status
+    std::string body = R"({"code":"PGRST200","message":"Could not find a relationship","details":[{"landlord_id":"x"}]})";
+    CatalogBuilder builder;
+    CatalogReader reader(builder, CatalogReader::Table::Landlords);
+    REQUIRE(parse(body, reader, body.size()));
+    CHECK_FALSE(reader.valid());
+    CHECK(builder.join()->landlords.empty());
+}
+
+TEST_CASE("Catalog response parse time, DOM against SAX reader", "[.][benchmark][catalog][json]") {
+    std::mt19937 rng(8);
+    for(size_t landlords : {10000, 100000}) {
+        std::string body = write(embeddedRows("bench-sax" + std::to_string(landlords) + "-", landlords, rng));
+        std::string size = std::to_string(landlords) + " landlords (" + std::to_string(body.size() >> 20) + " MiB)";
+        const size_t chunk = 16384;
+
+        BENCHMARK("Json::Value then structs, " + size) {
+            JsonValueBuilder dom;
+            parse(body, dom, chunk);
+            CatalogBuilder builder;
+            for(const auto &landlordRow : dom.result()) {
+                Landlord landlord = domLandlord(landlordRow);
+                for(const auto &propertyRow : landlordRow["properties"]) {
+                    Property property = domProperty(propertyRow);
+                    for(const auto &unitRow : propertyRow["units"]) builder.addUnit(property.key, domUnit(unitRow));
+                    builder.addProperty(landlord.key, std::move(property));
+                }
+                builder.addLandlord(std::move(landlord));
+            }
+            return builder.join();
+        };
+        BENCHMARK("CatalogReader, " + size) {
+            CatalogBuilder builder;
+            CatalogReader reader(builder, CatalogReader::Table::Embedded);
+            parse(body, reader, chunk);
+            return builder.join();
+        };
+    }
+}
@@ -0,0 +1,175 @@
+#include "controllers/Catalog.h"
+#include "controllers/CatalogBuilder.h"
+#include "controllers/FacetIndex.h"
+#include "controllers/IdInterner.h"
+#include "controllers/UnitStore.h"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // One landlord with one property in Kingston holding a unit per rent, in that order
+    std::shared_ptr<Catalog> catalogWithRents(const std::string &prefix, const std::vector<double> &rents) {
+        CatalogBuilder builder;
+        Landlord landlord;
+        landlord.landlordId = prefix + "LL";
+        landlord.key = IdInterner::landlords().intern(landlord.landlordId);
+        Property property;
+        property.propertyId = prefix + "P";
+        property.key = IdInterner::properties().intern(property.propertyId);
+        property.city = "Kingston";
+        property.province = "ON";
+        for(double rent : rents) {
+            Unit unit;
+            unit.rent = rent;
+            builder.addUnit(property.key, std::move(unit));
+        }
+        builder.addProperty(landlord.key, std::move(property));
+        builder.addLandlord(std::move(landlord));
+        auto catalog = builder.join();
+        catalog->index();
+        return catalog;
+    }
+
+    // Landlords with properties in a handful of cities (spelled in varying case) and units
+    // with rents in whole cents, many of them on or next to a rent bucket boundary
+    std::shared_ptr<Catalog> randomCatalog(const std::string &prefix, size_t landlordCount, std::mt19937 &rng) {
+        static const char *cities[] = {"Kingston", "KINGSTON", "Toronto", "Ottawa", "Napanee"};
+        static const char *provinces[] = {"ON", "on", "QC"};
+        CatalogBuilder builder;
+        for(size_t l = 0; l < landlordCount; l++) {
+            Landlord landlord;
+            landlord.landlordId = prefix + "LL" + std::to_string(l);
+            landlord.key = IdInterner::landlords().intern(landlord.landlordId);
+            for(uint32_t p = 0, properties = rng() % 4; p < properties; p++) {
+                Property property;
+                property.propertyId = landlord.landlordId + "_P" + std::to_string(p);
+                property.key = IdInterner::properties().intern(property.propertyId);
+                property.city = cities[rng() % 5];
+                property.province = provinces[rng() % 3];
+                for(uint32_t u = 0, units = rng() % 5; u < units; u++) {
+                    Unit unit;
+                    unit.bedrooms = static_cast<int>(rng() % 6);
+                    uint32_t cents = rng() % 4 ? 20000 + rng() % 400000 : (1 + rng() % 16) * 25000 - rng() % 2;
+                    unit.rent = cents / 100.0;
+                    builder.addUnit(property.key, std::move(unit));
+                }
+                builder.addProperty(landlord.key, std::move(property));
+            }
+            builder.addLandlord(std::move(landlord));
+        }
+        auto catalog = builder.join();
+        catalog->index();
+        return catalog;
+    }
+
+    std::string lower(std::string text) {
+        for(char &c : text) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return text;
+    }
+
+    // Every unit checked against every filter
+    std::vector<uint32_t> naiveMatch(const Catalog &catalog, const FacetQuery &query) {
+        std::vector<uint32_t> units;
+        for(const auto &property : catalog.properties) {
+            for(uint32_t u = property.firstUnit; u < property.firstUnit + property.unitCount; u++) {
+                const Unit &unit = catalog.units[u];
+                if(!query.city.empty() && lower(property.city) != lower(query.city)) continue;
+                if(!query.province.empty() && lower(property.province) != lower(query.province)) continue;
+                if(query.minBedrooms && unit.bedrooms < *query.minBedrooms) continue;
+                if(query.maxBedrooms && unit.bedrooms > *query.maxBedrooms) continue;
+                if(query.minRent && unit.rent < *query.minRent - 1e-9) continue;
+                if(query.maxRent && unit.rent > *query.maxRent + 1e-9) continue;
+                units.push_back(u);
+            }
+        }
+        std::sort(units.begin(), units.end());
+        return units;
+    }
+
+    // A rent bound in whole cents, often exactly on a bucket boundary or a cent off it
+    double randomRent(std::mt19937 &rng) {
+        uint32_t cents = rng() % 3 ? rng() % 450000 : (rng() % 18) * 25000 + rng() % 3 - 1;
+        return cents / 100.0;
+    }
+
+    std::vector<uint32_t> rentRange(const Catalog &catalog, std::optional<double> minRent, std::optional<double> maxRent) {
+        FacetQuery query;
+        query.minRent = minRent;
+        query.maxRent = maxRent;
+        return catalog.facets().match(catalog.unitStore(), query).values();
+    }
+}
+
+TEST_CASE("Rent bounds keep units at exactly the bound", "[facets]") {
+    // Rents whose dollars * 100 lands just below or above the whole cent
+    std::vector<double> rents = {4.35, 1.1, 1150.1, 10.29, 1234567.89};
+    auto catalog = catalogWithRents("rent-bounds-", rents);
+
+    for(uint32_t u = 0; u < rents.size(); u++) {
+        INFO("rent " << rents[u]);
+        CHECK(rentRange(*catalog, rents[u], rents[u]) == std::vector<uint32_t>{u});
+    }
+    CHECK(rentRange(*catalog, 4.35, 10.29) == std::vector<uint32_t>{0, 3});
+    CHECK(rentRange(*catalog, 4.351, 10.289).empty());
+    CHECK(rentRange(*catalog, 1.1, std::nullopt) == std::vector<uint32_t>{0, 1, 2, 3, 4});
+    CHECK(rentRange(*catalog, std::nullopt, 1.1) == std::vector<uint32_t>{1});
+    CHECK(rentRange(*catalog, -5, 1.09).empty());
+    CHECK(rentRange(*catalog, 2000000, std::nullopt).empty());
+}
+
+TEST_CASE("FacetIndex matches the same units as a scan of the catalog", "[facets]") {
+    std::mt19937 rng(22);
+    auto catalog = randomCatalog("facets-", 2000, rng);
+    const FacetIndex &facets = catalog->facets();
+    const UnitStore &store = catalog->unitStore();
+
+    for(int q = 0; q < 2000; q++) {
+        FacetQuery query;
+        if(rng() % 3 == 0) query.city = rng() % 8 ? "kingston" : "Nowhere";
+        if(rng() % 4 == 0) query.province = "On";
+        if(rng() % 3 == 0) query.minBedrooms = static_cast<int>(rng() % 7) - 1;
+        if(rng() % 3 == 0) query.maxBedrooms = static_cast<int>(rng() % 7) - 1;
+        if(rng() % 2) query.minRent = randomRent(rng);
+        if(rng() % 2) query.maxRent = randomRent(rng);
+        INFO("city \"" << query.city << "\", province \"" << query.province << "\", bedrooms "
+             << query.minBedrooms.value_or(-99) << "-" << query.maxBedrooms.value_or(99) << ", rent "
+             << query.minRent.value_or(-1) << "-" << query.maxRent.value_or(-1));
+        REQUIRE(facets.match(store, query).values() == naiveMatch(*catalog, query));
+    }
+}
+
+TEST_CASE("Facet search over 100k units", "[.][benchmark][facets]") {
+    std::mt19937 rng(23);
+    auto catalog = randomCatalog("bench-facets-", 40000, rng);
+    const FacetIndex &facets = catalog->facets();
+    const UnitStore &store = catalog->unitStore();
+
+    struct Range {
+        const char *label;
+        uint32_t minCents;
+        uint32_t maxCents;
+    };
+    for(const Range &range : {Range{"narrow rent range", 140000, 152500}, Range{"wide rent range", 60010, 389990}}) {
+        FacetQuery query;
+        query.minRent = range.minCents / 100.0;
+        query.maxRent = range.maxCents / 100.0;
+        // A rent filter without the buckets: check every unit's rent and build a bitmap
+        BENCHMARK(std::string(range.label) + ", scan of the rent column") {
+            Bitmap bitmap;
+            for(uint32_t u = 0; u < store.size(); u++) {
+                if(store.rentCents[u] >= range.minCents && store.rentCents[u] <= range.maxCents) bitmap.append(u);
+            }
+            return bitmap.cardinality();
+        };
+        BENCHMARK(std::string(range.label) + ", OR of rent buckets") {
+            return facets.match(store, query).cardinality();
+        };
+    }
+}
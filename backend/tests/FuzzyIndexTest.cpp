@@ -0,0 +1,146 @@
+#include "controllers/FuzzyIndex.h"
+#include <catch2/catch.hpp>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::string alphabet = "abc ";
+
+    // Every string within maxDistance single edits (insert, delete, substitute, swap two
+    // adjacent bytes) of text, with the fewest edits that reach it. Edits are over alphabet,
+    // which covers every byte of the indexed terms, so this is the edit distance by definition
+    std::map<std::string, int> editBall(const std::string &text, int maxDistance) {
+        std::map<std::string, int> reached{{text, 0}};
+        std::vector<std::string> frontier{text};
+        for(int distance = 1; distance <= maxDistance; distance++) {
+            std::vector<std::string> next;
+            auto visit = [&](const std::string &candidate) {
+                if(reached.emplace(candidate, distance).second) next.push_back(candidate);
+            };
+            for(const auto &from : frontier) {
+                for(size_t i = 0; i <= from.size(); i++) {
+                    for(char c : alphabet) visit(from.substr(0, i) + c + from.substr(i));
+                    if(i == from.size()) continue;
+                    visit(from.substr(0, i) + from.substr(i + 1));
+                    for(char c : alphabet) if(c != from[i]) visit(from.substr(0, i) + c + from.substr(i + 1));
+                    if(i + 1 < from.size()) {
+                        std::string swapped = from;
+                        std::swap(swapped[i], swapped[i + 1]);
+                        visit(swapped);
+                    }
+                }
+            }
+            frontier.swap(next);
+        }
+        return reached;
+    }
+
+    // The terms FuzzyIndex keeps for a lower case name: the whole name and each word of it
+    std::set<std::string> terms(const std::string &name) {
+        std::set<std::string> result;
+        if(name.empty()) return result;
+        result.insert(name);
+        size_t start = 0;
+        while(start < name.size()) {
+            size_t end = name.find(' ', start);
+            if(end == std::string::npos) end = name.size();
+            if(end > start) result.insert(name.substr(start, end - start));
+            start = end + 1;
+        }
+        return result;
+    }
+
+    std::vector<FuzzyIndex::Match> naiveFind(const std::vector<std::string> &names, const std::string &query, int maxDistance) {
+        std::map<std::string, int> ball = editBall(query, maxDistance);
+        std::vector<FuzzyIndex::Match> matches;
+        for(uint32_t i = 0; i < names.size(); i++) {
+            int best = maxDistance + 1;
+            for(const auto &term : terms(names[i])) {
+                auto it = ball.find(term);
+                if(it != ball.end()) best = std::min(best, it->second);
+            }
+            if(best <= maxDistance) matches.push_back({i, best});
+        }
+        return matches;
+    }
+
+    std::vector<std::pair<uint32_t, int>> pairs(const std::vector<FuzzyIndex::Match> &matches) {
+        std::vector<std::pair<uint32_t, int>> result;
+        for(const auto &match : matches) result.push_back({match.position, match.distance});
+        return result;
+    }
+
+    std::string randomWord(std::mt19937 &rng) {
+        std::string word;
+        for(size_t i = 0, length = 1 + rng() % 5; i < length; i++) word += "abc"[rng() % 3];
+        return word;
+    }
+}
+
+TEST_CASE("FuzzyIndex counts a swap of adjacent letters as one edit", "[names]") {
+    FuzzyIndex index;
+    index.build({"Smith Rentals", "Smyth Homes", "abc", "Jones"});
+
+    std::vector<std::pair<uint32_t, int>> expected = {{0, 1}};
+    CHECK(pairs(index.find("smtih", 1)) == expected);
+    expected = {{0, 0}, {1, 1}};
+    CHECK(pairs(index.find("SMITH", 1)) == expected);
+    expected = {{0, 1}, {1, 2}};
+    CHECK(pairs(index.find("smtih", 2)) == expected);
+
+    // Swap then insert between the swapped letters: two edits, where the restricted
+    // (optimal string alignment) distance would say three
+    expected = {{2, 2}};
+    CHECK(pairs(index.find("ca", 2)) == expected);
+    CHECK(index.find("ca", 1).empty());
+}
+
+TEST_CASE("FuzzyIndex finds the same names as a scan of every name", "[names]") {
+    std::mt19937 rng(19);
+    std::vector<std::string> names;
+    for(int i = 0; i < 300; i++) {
+        std::string name = randomWord(rng);
+        if(rng() % 2) name += " " + randomWord(rng);
+        names.push_back(name);
+    }
+    names.push_back("");
+    FuzzyIndex index;
+    index.build(names);
+
+    for(int q = 0; q < 200; q++) {
+        std::string query = randomWord(rng);
+        int maxDistance = static_cast<int>(rng() % 3);
+        INFO("query \"" << query << "\" within " << maxDistance);
+        REQUIRE(pairs(index.find(query, maxDistance)) == pairs(naiveFind(names, query, maxDistance)));
+    }
+
+    FuzzyIndex empty;
+    empty.build({});
+    CHECK(empty.find("abc", 2).empty());
+}
+
+TEST_CASE("Fuzzy index over 100k landlords", "[.][benchmark][names]") {
+    std::mt19937 rng(20);
+    static const char *first[] = {"Maple", "Queen's", "Princess", "Limestone", "Frontenac", "Harbour", "King", "Union"};
+    static const char *last[] = {"Properties", "Rentals", "Holdings", "Homes", "Management", "Living", "Realty"};
+    std::vector<std::string> names;
+    for(int i = 0; i < 100000; i++) {
+        names.push_back(std::string(first[rng() % 8]) + " " + last[rng() % 7] + " " + std::to_string(rng() % 100000));
+    }
+
+    BENCHMARK("build") {
+        FuzzyIndex index;
+        index.build(names);
+        return index.find("x", 0).size();
+    };
+    FuzzyIndex index;
+    index.build(names);
+    for(const char *query : {"rnetals", "frontenca", "12345"}) {
+        BENCHMARK(std::string("\"") + query + "\" within 2") {
+            return index.find(query, 2);
+        };
+    }
+}
@@ -0,0 +1,83 @@
+#include "controllers/JsonStream.h"
+#include <catch2/catch.hpp>
+#include <json/json.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    // Parse text fed in chunks of the given size, as curl would
+    Json::Value parse(const std::string &text, size_t chunk) {
+        JsonValueBuilder builder;
+        JsonStreamParser parser(builder);
+        for(size_t at = 0; at < text.size(); at += chunk) {
+            REQUIRE(parser.feed(text.data() + at, std::min(chunk, text.size() - at)));
+        }
+        INFO(parser.error());
+        REQUIRE(parser.finish());
+        return builder.result();
+    }
+
+    Json::Value readerParse(const std::string &text) {
+        Json::CharReaderBuilder reader;
+        std::unique_ptr<Json::CharReader> parser(reader.newCharReader());
+        Json::Value value;
+        std::string errors;
+        REQUIRE(parser->parse(text.data(), text.data() + text.size(), &value, &errors));
+        return value;
+    }
+}
+
+TEST_CASE("Integers past 64 bits are read as doubles, like Json::Reader", "[json]") {
+    const std::vector<std::string> numbers = {
+        "0", "-0", "42", "-42",
+        "9223372036854775807", "9223372036854775808", "18446744073709551615", "18446744073709551616",
+        "-9223372036854775807", "-9223372036854775808", "-9223372036854775809", "-18446744073709551616",
+        "123456789012345678901234567890", "-123456789012345678901234567890",
+    };
+    for(const auto &number : numbers) {
+        INFO(number);
+        Json::Value value = parse("[" + number + "]", 1)[0];
+        CHECK(value == readerParse("[" + number + "]")[0]);
+    }
+
+    Json::Value min = parse("-9223372036854775808", 64);
+    REQUIRE(min.isInt64());
+    CHECK(min.asInt64() == Json::Value::minInt64);
+    CHECK(parse("18446744073709551615", 64).asUInt64() == Json::Value::maxUInt64);
+    Json::Value huge = parse("-18446744073709551616", 64);
+    REQUIRE(huge.isDouble());
+    CHECK(huge.asDouble() == -18446744073709551616.0);
+}
+
+TEST_CASE("Unpaired surrogate escapes read as U+FFFD", "[json]") {
+    const std::string replacement = "\xef\xbf\xbd";
+    const std::vector<std::pair<std::string, std::string>> strings = {
+        {R"("a\ud83d\ude00b")", "a\xf0\x9f\x98\x80" "b"},
+        {R"("\ud83dx")", replacement + "x"},
+        {R"("\ud83d")", replacement},
+        {R"("\ud83d\n")", replacement + "\n"},
+        {R"("\ud83d\"")", replacement + "\""},
+        {R"("\ud83d\u0041")", replacement + "A"},
+        {R"("\ud83d\ud83d\ude00")", replacement + "\xf0\x9f\x98\x80"},
+        {R"("\ude00")", replacement},
+        {R"("\ude00\ud83d")", replacement + replacement},
+    };
+    for(const auto &string : strings) {
+        // Every chunk size, so escapes and surrogate pairs are split at every byte
+        for(size_t chunk = 1; chunk <= string.first.size(); chunk++) {
+            INFO(string.first << " in chunks of " << chunk);
+            REQUIRE(parse(string.first, chunk).asString() == string.second);
+        }
+    }
+
+    // Keys go through the same path
+    CHECK(parse(R"({"\ud83d":1})", 1).isMember(replacement));
+
+    JsonValueBuilder builder;
+    JsonStreamParser parser(builder);
+    CHECK_FALSE(parser.feed(R"("\ud83d\x")", 10));
+    CHECK(parser.error() == "invalid escape in string");
+}
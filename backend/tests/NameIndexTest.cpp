@@ -0,0 +1,98 @@
+#include "controllers/NameIndex.h"
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // What search did before the index: fold every name and look for the folded query
+    std::vector<uint32_t> naiveFind(const std::vector<std::string> &names, const std::string &query) {
+        std::string folded = NameIndex::fold(query);
+        std::vector<uint32_t> matches;
+        for(uint32_t i = 0; i < names.size(); i++) {
+            if(NameIndex::fold(names[i]).find(folded) != std::string::npos) matches.push_back(i);
+        }
+        return matches;
+    }
+
+    // Names from a small alphabet, so trigrams repeat across names and queries hit often
+    std::string randomText(std::mt19937 &rng, size_t minLength, size_t maxLength) {
+        static const std::string alphabet = "abcdeABCDE -'\xc3\xa9";
+        size_t length = minLength + rng() % (maxLength - minLength + 1);
+        std::string text;
+        for(size_t i = 0; i < length; i++) text += alphabet[rng() % alphabet.size()];
+        return text;
+    }
+
+    std::vector<std::string> landlordNames(size_t count, std::mt19937 &rng) {
+        static const char *first[] = {"Maple", "Queen's", "Princess", "Limestone", "Frontenac", "Harbour", "King", "Union"};
+        static const char *last[] = {"Properties", "Rentals", "Holdings", "Homes", "Management", "Living", "Realty"};
+        std::vector<std::string> names;
+        for(size_t i = 0; i < count; i++) {
+            names.push_back(std::string(first[rng() % 8]) + " " + last[rng() % 7] + " " + std::to_string(rng() % 100000));
+        }
+        return names;
+    }
+}
+
+TEST_CASE("NameIndex finds the same names as a fold-and-scan", "[names]") {
+    std::mt19937 rng(17);
+    std::vector<std::string> names;
+    for(int i = 0; i < 2000; i++) names.push_back(randomText(rng, 0, 24));
+    names.push_back("");
+    names.push_back("O'Brien & Sons");
+    NameIndex index;
+    index.build(names);
+
+    // Queries of every length around the trigram size, cut from names so most of them match
+    for(int q = 0; q < 3000; q++) {
+        std::string query;
+        if(q % 3 == 0) {
+            query = randomText(rng, 0, 8);
+        } else {
+            const std::string &name = names[rng() % names.size()];
+            size_t start = name.empty() ? 0 : rng() % name.size();
+            query = name.substr(start, rng() % 9);
+        }
+        INFO("query \"" << query << "\"");
+        REQUIRE(index.find(query) == naiveFind(names, query));
+    }
+    CHECK(index.find("o'BRIEN") == std::vector<uint32_t>{static_cast<uint32_t>(names.size() - 1)});
+    CHECK(index.find("zzz").empty());
+}
+
+TEST_CASE("NameIndex handles empty catalogs and queries", "[names]") {
+    NameIndex index;
+    index.build({});
+    CHECK(index.find("").empty());
+    CHECK(index.find("abc").empty());
+
+    index.build({"Alpha", "beta", "GAMMA"});
+    CHECK(index.find("") == std::vector<uint32_t>{0, 1, 2});
+    CHECK(index.find("A") == std::vector<uint32_t>{0, 1, 2});
+    CHECK(index.find("mm") == std::vector<uint32_t>{2});
+    CHECK(index.find("ETA") == std::vector<uint32_t>{1});
+    CHECK(index.find(std::string("al\0", 3)).empty());
+}
+
+TEST_CASE("Name search over 100k landlords", "[.][benchmark][names]") {
+    std::mt19937 rng(18);
+    std::vector<std::string> names = landlordNames(100000, rng);
+    NameIndex index;
+    index.build(names);
+
+    BENCHMARK("build index") {
+        NameIndex built;
+        built.build(names);
+        return built.find("x").size();
+    };
+    for(const char *query : {"ma", "rentals", "queen's homes", "12345"}) {
+        std::string label = std::string("\"") + query + "\"";
+        BENCHMARK("fold and scan every name, " + label) {
+            return naiveFind(names, query);
+        };
+        BENCHMARK("NameIndex, " + label) {
+            return index.find(query);
+        };
+    }
+}
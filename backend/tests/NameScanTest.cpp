@@ -0,0 +1,149 @@
+#include "controllers/NameScan.h"
+#include <catch2/catch.hpp>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    const NameScanKernel kernels[] = {NameScanKernel::Scalar, NameScanKernel::Sse42, NameScanKernel::Avx2};
+
+    const char *kernelName(NameScanKernel kernel) {
+        switch(kernel) {
+        case NameScanKernel::Scalar: return "scalar";
+        case NameScanKernel::Sse42: return "SSE4.2";
+        case NameScanKernel::Avx2: return "AVX2";
+        }
+        return "?";
+    }
+
+    // An arena whose NAME_SCAN_PADDING bytes end exactly at an inaccessible page, so a kernel
+    // that reads past the padding faults instead of passing by luck
+    class GuardedArena {
+    public:
+        explicit GuardedArena(const std::vector<std::string> &strings) {
+            offsets_.push_back(0);
+            std::string bytes;
+            for(const auto &text : strings) {
+                bytes += text;
+                bytes += '\0';
+                offsets_.push_back(static_cast<uint32_t>(bytes.size()));
+            }
+            bytes.append(NAME_SCAN_PADDING, '\0');
+
+            size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t dataPages = (bytes.size() + page - 1) / page;
+            mapped_ = (dataPages + 1) * page;
+            base_ = static_cast<char *>(mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            REQUIRE(base_ != MAP_FAILED);
+            REQUIRE(mprotect(base_ + dataPages * page, page, PROT_NONE) == 0);
+            data_ = base_ + dataPages * page - bytes.size();
+            std::memcpy(data_, bytes.data(), bytes.size());
+        }
+        ~GuardedArena() { munmap(base_, mapped_); }
+        GuardedArena(const GuardedArena &) = delete;
+        GuardedArena &operator=(const GuardedArena &) = delete;
+
+        std::vector<uint32_t> scan(NameScanKernel kernel, const std::string &needle) const {
+            uint32_t count = static_cast<uint32_t>(offsets_.size() - 1);
+            std::vector<uint32_t> matches(count);
+            matches.resize(scanNamesWith(kernel, data_, offsets_.data(), count, needle, matches.data()));
+            return matches;
+        }
+
+    private:
+        std::vector<uint32_t> offsets_;
+        char *base_ = nullptr;
+        char *data_ = nullptr;
+        size_t mapped_ = 0;
+    };
+
+    std::vector<uint32_t> reference(const std::vector<std::string> &strings, const std::string &needle) {
+        std::vector<uint32_t> matches;
+        for(uint32_t i = 0; i < strings.size(); i++) {
+            if(strings[i].find(needle) != std::string::npos) matches.push_back(i);
+        }
+        return matches;
+    }
+
+    std::string randomText(std::mt19937 &rng, size_t length) {
+        std::string text;
+        for(size_t i = 0; i < length; i++) text += "abcab "[rng() % 6];
+        return text;
+    }
+}
+
+TEST_CASE("Name scan kernels agree with std::string::find", "[names]") {
+    INFO("fastest kernel on this CPU: " << kernelName(bestNameScanKernel()));
+    std::mt19937 rng(20);
+    for(int round = 0; round < 40; round++) {
+        std::vector<std::string> strings;
+        for(size_t i = 0, count = rng() % 200; i < count; i++) strings.push_back(randomText(rng, rng() % 70));
+        GuardedArena arena(strings);
+
+        // Needle lengths on both sides of the 16-byte PCMPESTRI prefix and the AVX2 limit
+        for(size_t length : {1, 2, 3, 5, 15, 16, 17, 31, 32, 33, 40, 80}) {
+            std::string needle;
+            if(!strings.empty() && rng() % 2) {
+                const std::string &source = strings[rng() % strings.size()];
+                needle = source.substr(source.empty() ? 0 : rng() % source.size(), length);
+            }
+            if(needle.empty()) needle = randomText(rng, length);
+            std::vector<uint32_t> expected = reference(strings, needle);
+            for(NameScanKernel kernel : kernels) {
+                INFO(kernelName(kernel) << ", needle \"" << needle << "\"");
+                REQUIRE(arena.scan(kernel, needle) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Name scan kernels stay inside the arena padding", "[names]") {
+    // Matches in the last bytes before the padding, in strings of every length up to a few
+    // vector widths, so the wide loads reach as far into the padding as they ever do
+    for(size_t length = 1; length <= 70; length++) {
+        std::vector<std::string> strings = {"head", std::string(length - 1, 'x') + "z"};
+        GuardedArena arena(strings);
+        for(NameScanKernel kernel : kernels) {
+            INFO(kernelName(kernel) << ", last string of " << length << " bytes");
+            CHECK(arena.scan(kernel, "z") == std::vector<uint32_t>{1});
+            CHECK(arena.scan(kernel, "xz") == (length > 1 ? std::vector<uint32_t>{1} : std::vector<uint32_t>{}));
+            CHECK(arena.scan(kernel, std::string(length, 'x')).empty());
+            CHECK(arena.scan(kernel, "q").empty());
+        }
+    }
+
+    GuardedArena empty(std::vector<std::string>{});
+    for(NameScanKernel kernel : kernels) CHECK(empty.scan(kernel, "a").empty());
+}
+
+TEST_CASE("Name scan does not match across strings", "[names]") {
+    GuardedArena arena(std::vector<std::string>{"abc", "def", "", "cd"});
+    for(NameScanKernel kernel : kernels) {
+        INFO(kernelName(kernel));
+        CHECK(arena.scan(kernel, "cd") == std::vector<uint32_t>{3});
+        CHECK(arena.scan(kernel, "abcdef").empty());
+        CHECK(arena.scan(kernel, "") == std::vector<uint32_t>{0, 1, 2, 3});
+        CHECK(arena.scan(kernel, std::string("c\0d", 3)).empty());
+    }
+}
+
+TEST_CASE("Name scan kernels over 100k names", "[.][benchmark][names]") {
+    std::mt19937 rng(21);
+    static const char *words[] = {"maple", "queen's", "princess", "limestone", "rentals", "holdings", "homes", "realty"};
+    std::vector<std::string> strings;
+    for(int i = 0; i < 100000; i++) {
+        strings.push_back(std::string(words[rng() % 8]) + " " + words[rng() % 8] + " " + std::to_string(rng() % 100000));
+    }
+    GuardedArena arena(strings);
+
+    for(const char *needle : {"ma", "rentals", "12345", "princess holdings 4"}) {
+        for(NameScanKernel kernel : kernels) {
+            BENCHMARK(std::string(kernelName(kernel)) + ", \"" + needle + "\"") {
+                return arena.scan(kernel, needle);
+            };
+        }
+    }
+}
@@ -0,0 +1,163 @@
+#include "PostgrestStub.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+    bool sendAll(int fd, const std::string &data) {
+        size_t sent = 0;
+        while(sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if(n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    std::mutex sharedMutex;
+    PostgrestStub::Handler sharedHandler;
+
+    const char *reason(int status) {
+        switch(status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        default: return "Error";
+        }
+    }
+}
+
+PostgrestStub::PostgrestStub(Handler handler) : handler_(std::move(handler)) {
+    listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if(listenFd_ < 0) throw std::runtime_error("socket failed");
+    int yes = 1;
+    ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if(::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listenFd_, 16) < 0) {
+        ::close(listenFd_);
+        throw std::runtime_error("bind or listen failed");
+    }
+    socklen_t length = sizeof(addr);
+    ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &length);
+    port_ = ntohs(addr.sin_port);
+    acceptThread_ = std::thread([this]() { acceptLoop(); });
+}
+
+PostgrestStub::~PostgrestStub() {
+    stopping_ = true;
+    ::shutdown(listenFd_, SHUT_RDWR);
+    ::close(listenFd_);
+    acceptThread_.join();
+
+    std::vector<std::thread> connections;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        for(int fd : connectionFds_) ::shutdown(fd, SHUT_RDWR);
+        connections.swap(connections_);
+    }
+    for(auto &connection : connections) connection.join();
+    // Descriptors are closed only now, so shutdown above never hits a reused number
+    for(int fd : connectionFds_) ::close(fd);
+}
+
+PostgrestStub &PostgrestStub::shared(Handler handler) {
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        sharedHandler = std::move(handler);
+    }
+    static PostgrestStub stub([](const std::string &method, const std::string &target) {
+        Handler handler;
+        {
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            handler = sharedHandler;
+        }
+        return handler(method, target);
+    });
+    static bool configured = [] {
+        setenv("SUPABASE_URL", stub.url().c_str(), 1);
+        setenv("SUPABASE_SERVICE_ROLE_KEY", "test-key", 1);
+        setenv("SUPABASE_CACHE_SOFT_TTL_SECONDS", "1", 1);
+        setenv("SUPABASE_CACHE_HARD_TTL_SECONDS", "1", 1);
+        return true;
+    }();
+    (void)configured;
+    return stub;
+}
+
+std::string PostgrestStub::url() const {
+    return "http://127.0.0.1:" + std::to_string(port_);
+}
+
+std::vector<std::string> PostgrestStub::takeRequests() {
+    std::lock_guard<std::mutex> lk(mu_);
+    std::vector<std::string> requests;
+    requests.swap(requests_);
+    return requests;
+}
+
+void PostgrestStub::acceptLoop() {
+    while(!stopping_) {
+        int fd = ::accept(listenFd_, nullptr, nullptr);
+        if(fd < 0) {
+            if(stopping_) return;
+            continue;
+        }
+        std::lock_guard<std::mutex> lk(mu_);
+        connectionFds_.push_back(fd);
+        connections_.emplace_back([this, fd]() { serve(fd); });
+    }
+}
+
+void PostgrestStub::serve(int fd) {
+    std::string buffer;
+    char chunk[4096];
+    while(!stopping_) {
+        // Read one request: the head up to the blank line, then Content-Length bytes of body
+        size_t headEnd;
+        while((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if(n <= 0) return;
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        std::string head = buffer.substr(0, headEnd);
+        std::string lowerHead = head;
+        std::transform(lowerHead.begin(), lowerHead.end(), lowerHead.begin(), [](unsigned char c) { return std::tolower(c); });
+        size_t bodyLength = 0;
+        size_t lengthHeader = lowerHead.find("\r\ncontent-length:");
+        if(lengthHeader != std::string::npos) {
+            bodyLength = std::strtoul(head.c_str() + lengthHeader + 17, nullptr, 10);
+        }
+        while(buffer.size() < headEnd + 4 + bodyLength) {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if(n <= 0) return;
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        buffer.erase(0, headEnd + 4 + bodyLength);
+
+        std::string requestLine = head.substr(0, head.find("\r\n"));
+        size_t space = requestLine.find(' ');
+        std::string method = requestLine.substr(0, space);
+        std::string target = requestLine.substr(space + 1, requestLine.rfind(' ') - space - 1);
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            requests_.push_back(method + " " + target);
+        }
+
+        Reply reply = handler_(method, target);
+        std::string response = "HTTP/1.1 " + std::to_string(reply.status) + " " + reason(reply.status) + "\r\n"
+                               "Content-Type: application/json\r\n" + reply.headers +
+                               "Content-Length: " + std::to_string(reply.body.size()) + "\r\n\r\n";
+        if(method != "HEAD") response += reply.body;
+        if(!sendAll(fd, response)) return;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    What is the PostgrestStub?
+    A minimal HTTP/1.1 server on 127.0.0.1 that stands in for Supabase's PostgREST API in
+    tests. Every request is answered by the handler with a status and a JSON body, and the
+    request lines are recorded so a test can check which calls were made. Connections are
+    kept alive, as curl reuses them.
+*/
+class PostgrestStub {
+public:
+    struct Reply {
+        int status = 200;
+        std::string body = "[]";
+        std::string headers;    // extra header lines, each ending in "\r\n"
+    };
+
+    // method is e.g. "GET", target the path and query, e.g. "/rest/v1/units?select=rent"
+    using Handler = std::function<Reply(const std::string &method, const std::string &target)>;
+
+    explicit PostgrestStub(Handler handler);
+    ~PostgrestStub();
+    PostgrestStub(const PostgrestStub &) = delete;
+    PostgrestStub &operator=(const PostgrestStub &) = delete;
+
+    // The stub SupabaseHelper talks to, answering with handler from now on. SupabaseHelper
+    // reads its settings once per process, so every test shares one stub and installs its
+    // own handler. A one second cache TTL lets a test go back to the stub by waiting
+    static PostgrestStub &shared(Handler handler);
+
+    // Base URL to use as SUPABASE_URL
+    std::string url() const;
+
+    // "GET /rest/v1/..." for every request received so far; clears the record
+    std::vector<std::string> takeRequests();
+
+private:
+    void acceptLoop();
+    void serve(int fd);
+
+    Handler handler_;
+    int listenFd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread acceptThread_;
+    std::mutex mu_;
+    std::vector<std::thread> connections_;
+    std::vector<int> connectionFds_;
+    std::vector<std::string> requests_;
+};
@@ -0,0 +1,210 @@
+#include "controllers/Catalog.h"
+#include "controllers/CatalogBuilder.h"
+#include "controllers/IdInterner.h"
+#include "controllers/Projection.h"
+#include <catch2/catch.hpp>
+#include <json/json.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef RML_TESTS_DROGON
+#include "controllers/LandlordCtrl.h"
+#endif
+
+namespace {
+    // Landlords with zero to three properties of zero to three units. Text columns carry
+    // quotes, backslashes, control characters and UTF-8; rents are whole cents
+    std::shared_ptr<Catalog> makeCatalog(const std::string &prefix, size_t landlordCount, std::mt19937 &rng) {
+        CatalogBuilder builder;
+        for(size_t l = 0; l < landlordCount; l++) {
+            Landlord landlord;
+            landlord.landlordId = prefix + "LL" + std::to_string(l);
+            landlord.key = IdInterner::landlords().intern(landlord.landlordId);
+            landlord.name = "O\"Brien \\ Sons\t" + std::to_string(l) + "\x01\x1f \xc3\xa9";
+            landlord.email = "ll" + std::to_string(l) + "@example.com";
+            landlord.phone = l % 3 ? "613-555-0100\r\n" : "";
+            for(uint32_t p = 0, properties = rng() % 4; p < properties; p++) {
+                Property property;
+                property.propertyId = landlord.landlordId + "_P" + std::to_string(p);
+                property.key = IdInterner::properties().intern(property.propertyId);
+                property.street = std::to_string(p) + " Princess St\nUnit \"B\"";
+                property.city = "Kingston";
+                property.province = "ON";
+                property.zip = "K7L " + std::to_string(p);
+                for(uint32_t u = 0, units = rng() % 4; u < units; u++) {
+                    Unit unit;
+                    unit.unitNumber = std::to_string(u);
+                    unit.bedrooms = static_cast<int>(rng() % 5);
+                    unit.bathrooms = (1 + rng() % 4) * 0.5;
+                    unit.rent = (50000 + rng() % 300000) / 100.0;
+                    builder.addUnit(property.key, std::move(unit));
+                }
+                builder.addProperty(landlord.key, std::move(property));
+            }
+            builder.addLandlord(std::move(landlord));
+        }
+        auto catalog = builder.join();
+        catalog->index();
+        return catalog;
+    }
+
+    Json::Value parse(const std::string &text) {
+        Json::CharReaderBuilder reader;
+        std::unique_ptr<Json::CharReader> parser(reader.newCharReader());
+        Json::Value value;
+        std::string errors;
+        REQUIRE(parser->parse(text.data(), text.data() + text.size(), &value, &errors));
+        return value;
+    }
+
+    // The members of value on one of paths ("properties.address.city"), through arrays
+    Json::Value subset(const Json::Value &value, const std::vector<std::string> &paths) {
+        if(value.isArray()) {
+            Json::Value items(Json::arrayValue);
+            for(const auto &item : value) items.append(subset(item, paths));
+            return items;
+        }
+        Json::Value kept(Json::objectValue);
+        for(const auto &member : value.getMemberNames()) {
+            std::vector<std::string> below;
+            bool whole = false;
+            for(const auto &path : paths) {
+                if(path == member) whole = true;
+                else if(path.compare(0, member.size() + 1, member + ".") == 0) below.push_back(path.substr(member.size() + 1));
+            }
+            if(whole) kept[member] = value[member];
+            else if(!below.empty()) kept[member] = subset(value[member], below);
+        }
+        return kept;
+    }
+
+    std::shared_ptr<const Projection> compile(const std::vector<std::string> &paths) {
+        std::string fields, error;
+        for(const auto &path : paths) fields += path + ",";
+        auto projection = Projection::compile(fields, error);
+        INFO(error);
+        REQUIRE(projection);
+        return projection;
+    }
+
+    Json::Value project(const Projection &projection, const Catalog &catalog, const Landlord &landlord,
+                        const LandlordFigures &figures = LandlordFigures()) {
+        std::string out;
+        projection.write(out, catalog, landlord, figures);
+        return parse(out);
+    }
+}
+
+TEST_CASE("Projected entries equal the matching part of Catalog::toJson", "[projection]") {
+    std::mt19937 rng(24);
+    auto catalog = makeCatalog("projection-", 60, rng);
+    const std::vector<std::vector<std::string>> fieldSets = {
+        {"landlord_id"},
+        {"name", "contact"},
+        {"landlord_id", "name", "contact", "properties"},
+        {"properties.property_id", "properties.unit_details.rent"},
+        {"properties.address"},
+        {"contact.phone", "properties.address.city", "properties.unit_details.bathrooms"},
+        {"properties.unit_details"},
+    };
+    for(const auto &paths : fieldSets) {
+        auto projection = compile(paths);
+        for(const auto &landlord : catalog->landlords) {
+            Json::Value expected = subset(catalog->toJson(landlord), paths);
+            INFO(landlord.landlordId << " with " << paths.size() << " fields, first " << paths[0]);
+            REQUIRE(project(*projection, *catalog, landlord) == expected);
+        }
+    }
+
+    // Figures that are not in the catalog, in the shape search and the leaderboard use
+    LandlordFigures figures;
+    figures.averageRating = 4.25;
+    figures.reviewCount = 12;
+    figures.rank = 3;
+    const Landlord &landlord = catalog->landlords[1];
+    Json::Value entry = project(*compile({"average_rating", "review_count", "property_count", "unit_count", "rank", "distance"}),
+                                *catalog, landlord, figures);
+    CHECK(entry["average_rating"].asDouble() == 4.25);
+    CHECK(entry["review_count"].asUInt() == 12);
+    CHECK(entry["property_count"].asUInt() == landlord.propertyCount);
+    CHECK(entry["unit_count"].asUInt() == landlord.unitCount);
+    CHECK(entry["rank"].asUInt64() == 3);
+    CHECK_FALSE(entry.isMember("distance"));    // only fuzzy search has one
+}
+
+TEST_CASE("Projection escapes quotes, backslashes and control characters", "[projection]") {
+    std::string text = std::string("say \"hi\" \\ \b\f\n\r\t") + '\0' + "\x01\x1f\x7f \xc3\xa9 /";
+    std::string out;
+    Projection::writeString(out, text);
+    CHECK(out == "\"say \\\"hi\\\" \\\\ \\u0008\\u000c\\n\\r\\t\\u0000\\u0001\\u001f\x7f \xc3\xa9 /\"");
+    CHECK(parse("[" + out + "]")[0].asString() == text);
+
+    for(unsigned c = 0; c < 0x20; c++) {
+        std::string raw;
+        Projection::writeString(raw, std::string(1, static_cast<char>(c)));
+        INFO("byte " << c);
+        for(char written : raw) CHECK(static_cast<unsigned char>(written) >= 0x20);
+    }
+}
+
+TEST_CASE("Nested field masks keep only the named members", "[projection]") {
+    std::mt19937 rng(25);
+    auto catalog = makeCatalog("projection-nested-", 20, rng);
+    const Landlord *landlord = nullptr;
+    for(const auto &candidate : catalog->landlords) {
+        if(candidate.propertyCount > 0 && candidate.unitCount > 0) landlord = &candidate;
+    }
+    REQUIRE(landlord);
+
+    Json::Value entry = project(*compile({"properties.unit_details.rent", "contact.email"}), *catalog, *landlord);
+    CHECK(entry.getMemberNames() == std::vector<std::string>{"contact", "properties"});
+    CHECK(entry["contact"].getMemberNames() == std::vector<std::string>{"email"});
+    REQUIRE(entry["properties"].size() == landlord->propertyCount);
+    for(const auto &property : entry["properties"]) {
+        CHECK(property.getMemberNames() == std::vector<std::string>{"unit_details"});
+        for(const auto &unit : property["unit_details"]) CHECK(unit.getMemberNames() == std::vector<std::string>{"rent"});
+    }
+
+    entry = project(*compile({"properties.address", "properties.address.zip"}), *catalog, *landlord);
+    for(const auto &property : entry["properties"]) {
+        CHECK(property.getMemberNames() == std::vector<std::string>{"address"});
+        CHECK(property["address"].getMemberNames() == std::vector<std::string>{"city", "province", "street", "zip"});
+    }
+}
+
+TEST_CASE("Projection rejects unknown fields", "[projection]") {
+    std::string error;
+    CHECK_FALSE(Projection::compile("name,average_rating,bogus", error));
+    CHECK(error == "unknown field: bogus");
+    CHECK_FALSE(Projection::compile("properties.address.country", error));
+    CHECK(error == "unknown field: properties.address.country");
+    CHECK_FALSE(Projection::compile("contact.", error));
+    CHECK(error == "unknown field: contact.");
+    CHECK_FALSE(Projection::compile(",,", error));
+    CHECK(error == "fields must name at least one field");
+
+    // Equal field sets share one plan however they are spelled
+    error.clear();
+    auto plan = Projection::compile("name,rank", error);
+    REQUIRE(plan);
+    CHECK(Projection::compile("rank,name,,name", error) == plan);
+    CHECK(error.empty());
+}
+
+#ifdef RML_TESTS_DROGON
+TEST_CASE("Search answers an unknown field with 400", "[projection]") {
+    // The fields parameter is checked before the catalog is loaded, so no Supabase is needed
+    LandlordCtrl controller("", "");
+    auto req = drogon::HttpRequest::newHttpRequest();
+    req->setParameter("name", "smith");
+    req->setParameter("fields", "name,bogus");
+    drogon::HttpResponsePtr resp;
+    controller.search(req, [&resp](const drogon::HttpResponsePtr &r) { resp = r; });
+
+    REQUIRE(resp);
+    CHECK(resp->getStatusCode() == drogon::k400BadRequest);
+    REQUIRE(resp->getJsonObject());
+    CHECK((*resp->getJsonObject())["error"].asString() == "unknown field: bogus");
+}
+#endif
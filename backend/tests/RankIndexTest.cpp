@@ -0,0 +1,161 @@
+#include "controllers/RankIndex.h"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+    // Reference ranking: a vector kept sorted the way RankIndex orders its entries
+    struct Entry {
+        uint32_t id;
+        double score;
+
+        bool operator<(const Entry &other) const {
+            if(score != other.score) return score > other.score;
+            return id < other.id;
+        }
+        bool operator==(const Entry &other) const { return id == other.id && score == other.score; }
+    };
+
+    class SortedRanking {
+    public:
+        void insert(uint32_t id, double score) {
+            Entry entry{id, score};
+            entries_.insert(std::lower_bound(entries_.begin(), entries_.end(), entry), entry);
+        }
+
+        bool erase(uint32_t id, double score) {
+            Entry entry{id, score};
+            auto it = std::lower_bound(entries_.begin(), entries_.end(), entry);
+            if(it == entries_.end() || !(*it == entry)) return false;
+            entries_.erase(it);
+            return true;
+        }
+
+        long rank(uint32_t id, double score) const {
+            Entry entry{id, score};
+            auto it = std::lower_bound(entries_.begin(), entries_.end(), entry);
+            if(it == entries_.end() || !(*it == entry)) return -1;
+            return static_cast<long>(it - entries_.begin());
+        }
+
+        std::vector<uint32_t> range(size_t offset, size_t limit) const {
+            std::vector<uint32_t> ids;
+            for(size_t i = offset; i < entries_.size() && ids.size() < limit; i++) ids.push_back(entries_[i].id);
+            return ids;
+        }
+
+        size_t size() const { return entries_.size(); }
+        const std::vector<Entry> &entries() const { return entries_; }
+
+    private:
+        std::vector<Entry> entries_;
+    };
+
+    // Scores like a leaderboard's: few distinct values, so ties on score are common
+    double randomScore(std::mt19937 &rng) {
+        return static_cast<double>(rng() % 41) / 10.0 + 1.0;
+    }
+}
+
+TEST_CASE("RankIndex matches a sorted vector under random inserts and erases", "[rank]") {
+    std::mt19937 rng(14);
+    RankIndex index;
+    SortedRanking reference;
+    std::vector<Entry> live;
+
+    for(int step = 0; step < 20000; step++) {
+        unsigned op = rng() % 10;
+        if(op < 5 || live.empty()) {
+            Entry entry{static_cast<uint32_t>(rng() % 5000), randomScore(rng)};
+            if(reference.rank(entry.id, entry.score) >= 0) continue;   // one entry per (id, score)
+            index.insert(entry.id, entry.score);
+            reference.insert(entry.id, entry.score);
+            live.push_back(entry);
+        } else if(op < 8) {
+            size_t pick = rng() % live.size();
+            Entry entry = live[pick];
+            CHECK(index.erase(entry.id, entry.score));
+            reference.erase(entry.id, entry.score);
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            // Erasing an absent entry changes nothing
+            uint32_t id = static_cast<uint32_t>(5000 + rng() % 100);
+            CHECK_FALSE(index.erase(id, 3.0));
+        }
+        REQUIRE(index.size() == reference.size());
+
+        if(step % 500 == 0) {
+            REQUIRE(index.range(0, index.size()) == reference.range(0, reference.size()));
+        }
+        if(!live.empty()) {
+            const Entry &probe = live[rng() % live.size()];
+            REQUIRE(index.rank(probe.id, probe.score) == reference.rank(probe.id, probe.score));
+            CHECK(index.rank(probe.id, probe.score + 100) == -1);
+        }
+        size_t offset = rng() % (reference.size() + 10);
+        size_t limit = rng() % 30;
+        REQUIRE(index.range(offset, limit) == reference.range(offset, limit));
+    }
+
+    // Every position, not just sampled ones
+    for(size_t i = 0; i < reference.size(); i++) {
+        const Entry &entry = reference.entries()[i];
+        REQUIRE(index.rank(entry.id, entry.score) == static_cast<long>(i));
+    }
+}
+
+TEST_CASE("RankIndex breaks score ties by id", "[rank]") {
+    RankIndex index;
+    for(uint32_t id : {7u, 3u, 9u, 1u}) index.insert(id, 4.5);
+    index.insert(5, 5.0);
+    index.insert(2, 1.0);
+    CHECK(index.range(0, 10) == std::vector<uint32_t>{5, 1, 3, 7, 9, 2});
+    CHECK(index.rank(9, 4.5) == 4);
+    CHECK(index.range(6, 3).empty());
+
+    index.clear();
+    CHECK(index.size() == 0);
+    CHECK(index.range(0, 10).empty());
+    CHECK(index.rank(5, 5.0) == -1);
+}
+
+TEST_CASE("Leaderboard with 100k landlords", "[.][benchmark][rank]") {
+    const uint32_t landlords = 100000;
+    const size_t pageSize = 20;
+    std::mt19937 rng(15);
+    std::vector<double> scores(landlords);
+    RankIndex index;
+    for(uint32_t id = 0; id < landlords; id++) {
+        scores[id] = randomScore(rng);
+        index.insert(id, scores[id]);
+    }
+    // Pages across the whole board, as clients page through it
+    std::vector<size_t> offsets;
+    for(int i = 0; i < 64; i++) offsets.push_back(rng() % (landlords - pageSize));
+    size_t next = 0;
+
+    // What every leaderboard request did before the rankings were kept incrementally
+    BENCHMARK("page by sorting every request") {
+        std::vector<Entry> entries(landlords);
+        for(uint32_t id = 0; id < landlords; id++) entries[id] = Entry{id, scores[id]};
+        size_t offset = offsets[next++ % offsets.size()];
+        std::partial_sort(entries.begin(), entries.begin() + offset + pageSize, entries.end());
+        return entries[offset].id;
+    };
+    BENCHMARK("page from RankIndex") {
+        return index.range(offsets[next++ % offsets.size()], pageSize);
+    };
+    BENCHMARK("rank of one landlord") {
+        uint32_t id = static_cast<uint32_t>(offsets[next++ % offsets.size()]);
+        return index.rank(id, scores[id]);
+    };
+    BENCHMARK("rating change (erase and reinsert)") {
+        uint32_t id = static_cast<uint32_t>(offsets[next++ % offsets.size()]);
+        index.erase(id, scores[id]);
+        scores[id] = scores[id] >= 5.0 ? 1.0 : scores[id] + 0.1;
+        index.insert(id, scores[id]);
+        return index.size();
+    };
+}
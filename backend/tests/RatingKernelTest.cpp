@@ -0,0 +1,67 @@
+#include "controllers/RatingKernel.h"
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Synthetic review columns: mostly valid, with some unknown keys (including ones with
+    // the top bit set, which the AVX2 loop compares with a bias) and out of range ratings
+    struct Reviews {
+        std::vector<uint32_t> keys;
+        std::vector<uint8_t> ratings;
+    };
+
+    Reviews makeReviews(size_t count, uint32_t keyCount, std::mt19937 &rng) {
+        Reviews reviews;
+        reviews.keys.resize(count);
+        reviews.ratings.resize(count);
+        for(size_t i = 0; i < count; i++) {
+            unsigned pick = rng() % 20;
+            reviews.keys[i] = pick == 0 ? keyCount + rng() % 10
+                            : pick == 1 ? 0x80000000u | static_cast<uint32_t>(rng())
+                            : static_cast<uint32_t>(rng() % keyCount);
+            reviews.ratings[i] = pick == 2 ? static_cast<uint8_t>(rng()) : static_cast<uint8_t>(1 + rng() % 5);
+        }
+        return reviews;
+    }
+}
+
+TEST_CASE("countRatings counts valid reviews into per-landlord histograms", "[ratings]") {
+    std::vector<uint32_t> keys = {0, 1, 1, 2, 0, 1, 7, 2, 1, 1};
+    std::vector<uint8_t> ratings = {5, 1, 1, 3, 0, 6, 4, 5, 2, 5};
+    std::vector<uint32_t> histograms = countRatings(keys.data(), ratings.data(), keys.size(), 3);
+    CHECK(histograms == std::vector<uint32_t>{0, 0, 0, 0, 1,
+                                              2, 1, 0, 0, 1,
+                                              0, 0, 1, 0, 1});
+    CHECK(countRatings(nullptr, nullptr, 0, 2) == std::vector<uint32_t>(10, 0));
+}
+
+TEST_CASE("AVX2 and scalar rating kernels agree", "[ratings]") {
+    if(!ratingKernelUsesAvx2()) WARN("No AVX2 on this CPU; countRatings is the scalar loop");
+    std::mt19937 rng(16);
+    // Every tail length the 8-wide loop can leave behind, and a few larger inputs
+    for(size_t count : {0, 1, 7, 8, 9, 15, 16, 17, 31, 1000, 4099, 100003}) {
+        for(uint32_t keyCount : {1u, 13u, 5000u}) {
+            Reviews reviews = makeReviews(count, keyCount, rng);
+            INFO(count << " reviews, " << keyCount << " landlords");
+            CHECK(countRatings(reviews.keys.data(), reviews.ratings.data(), count, keyCount)
+                  == countRatingsScalar(reviews.keys.data(), reviews.ratings.data(), count, keyCount));
+        }
+    }
+}
+
+TEST_CASE("Rating kernel throughput", "[.][benchmark][ratings]") {
+    std::mt19937 rng(17);
+    const uint32_t keyCount = 100000;
+    for(size_t count : {size_t(1000000), size_t(10000000)}) {
+        Reviews reviews = makeReviews(count, keyCount, rng);
+        std::string size = std::to_string(count / 1000000) + "M reviews";
+        BENCHMARK("scalar, " + size) {
+            return countRatingsScalar(reviews.keys.data(), reviews.ratings.data(), count, keyCount);
+        };
+        BENCHMARK(std::string(ratingKernelUsesAvx2() ? "AVX2, " : "dispatched (scalar), ") + size) {
+            return countRatings(reviews.keys.data(), reviews.ratings.data(), count, keyCount);
+        };
+    }
+}
@@ -0,0 +1,180 @@
+#include "PostgrestStub.h"
+#include "controllers/RatingStore.h"
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+    using Review = std::tuple<std::string, std::string, int>;     // id, landlord_id, rating
+
+    // Holds every reviews request until released, then answers it with the reply. The state
+    // outlives the test case, as the stub may still be answering when it fails
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable changed;
+        int arrived = 0;
+        bool released = false;
+        PostgrestStub::Reply reply;
+
+        PostgrestStub::Reply hold() {
+            std::unique_lock<std::mutex> lock(mutex);
+            arrived++;
+            changed.notify_all();
+            changed.wait_for(lock, std::chrono::seconds(30), [this] { return released; });
+            return reply;
+        }
+
+        void waitArrived() {
+            std::unique_lock<std::mutex> lock(mutex);
+            REQUIRE(changed.wait_for(lock, std::chrono::seconds(10), [this] { return arrived > 0; }));
+        }
+
+        void release(PostgrestStub::Reply answer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            reply = std::move(answer);
+            released = true;
+            changed.notify_all();
+        }
+    };
+
+    PostgrestStub &serveReviews(const std::shared_ptr<Gate> &gate) {
+        PostgrestStub &server = PostgrestStub::shared([gate](const std::string &, const std::string &target) {
+            if(target.compare(0, 17, "/rest/v1/reviews?") == 0) return gate->hold();
+            PostgrestStub::Reply reply;
+            reply.status = 404;
+            reply.body = "{}";
+            return reply;
+        });
+        server.takeRequests();
+        return server;
+    }
+
+    PostgrestStub::Reply rows(const std::vector<Review> &reviews) {
+        PostgrestStub::Reply reply;
+        reply.body = "[";
+        for(const auto &review : reviews) {
+            if(reply.body.size() > 1) reply.body += ",";
+            reply.body += "{\"id\":\"" + std::get<0>(review) + "\",\"landlord_id\":\"" + std::get<1>(review) +
+                          "\",\"rating\":" + std::to_string(std::get<2>(review)) + "}";
+        }
+        reply.body += "]";
+        return reply;
+    }
+
+    PostgrestStub::Reply failure() {
+        PostgrestStub::Reply reply;
+        reply.status = 500;
+        reply.body = "{\"message\":\"connection to the database failed\"}";
+        return reply;
+    }
+
+    template <typename Predicate>
+    bool eventually(Predicate done) {
+        for(int i = 0; i < 1000 && !done(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return done();
+    }
+
+    // Reconcile against reviews, with the reload held until during has run
+    template <typename During>
+    void reconcileWith(const std::vector<Review> &reviews, During during) {
+        auto gate = std::make_shared<Gate>();
+        PostgrestStub &server = serveReviews(gate);
+        RatingStore &store = RatingStore::instance();
+        store.reconcile();
+        gate->waitArrived();
+        during();
+        uint64_t version = store.version();
+        gate->release(rows(reviews));
+        REQUIRE(eventually([&] { return store.version() > version; }));
+        CHECK(server.takeRequests().size() == 1);
+    }
+}
+
+// The first two cases need a store that has never loaded, so they come first; ctest runs
+// every case in a process of its own
+
+TEST_CASE("whenReady callers queued before a failed load are all answered", "[ratings]") {
+    auto gate = std::make_shared<Gate>();
+    PostgrestStub &server = serveReviews(gate);
+    RatingStore &store = RatingStore::instance();
+    REQUIRE(store.version() == 0);
+
+    auto answered = std::make_shared<std::atomic<int>>(0);
+    for(int i = 0; i < 3; i++) store.whenReady([answered] { (*answered)++; });
+    gate->waitArrived();
+    CHECK(*answered == 0);
+
+    gate->release(failure());
+    REQUIRE(eventually([&] { return *answered == 3; }));
+    CHECK(server.takeRequests().size() == 1);
+    CHECK(store.get("rs-wait-LL").count == 0);
+}
+
+TEST_CASE("Concurrent callers of a failing load start only one reconcile", "[ratings]") {
+    RatingStore &store = RatingStore::instance();
+    for(int round = 0; round < 2; round++) {
+        // Every caller finds the ratings unloaded at once; after the failure they still are
+        auto gate = std::make_shared<Gate>();
+        PostgrestStub &server = serveReviews(gate);
+        auto answered = std::make_shared<std::atomic<int>>(0);
+        std::vector<std::thread> callers;
+        for(int i = 0; i < 8; i++) {
+            callers.emplace_back([&store, answered] {
+                store.whenReady([answered] { (*answered)++; });
+                store.reconcile();
+            });
+        }
+        for(auto &caller : callers) caller.join();
+        gate->waitArrived();
+
+        gate->release(failure());
+        INFO("round " << round);
+        REQUIRE(eventually([&] { return *answered == 8; }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        CHECK(*answered == 8);
+        CHECK(server.takeRequests().size() == 1);
+    }
+}
+
+TEST_CASE("A review added during a reconcile is replayed exactly once by review id", "[ratings]") {
+    RatingStore &store = RatingStore::instance();
+    reconcileWith({{"rs-add-1", "rs-add-LL", 4}, {"rs-add-2", "rs-add-LL", 5}}, [&store] {
+        store.addReview("rs-add-2", "rs-add-LL", 5);   // stored before the reload read the table
+        store.addReview("rs-add-3", "rs-add-LL", 3);   // stored after it
+        // Already reconciling: must not forget the reviews recorded so far
+        store.reconcile();
+    });
+    LandlordRating rating = store.get("rs-add-LL");
+    CHECK(rating.count == 3);
+    CHECK(rating.sum == 12);
+    CHECK(rating.histogram[2] == 1);
+    CHECK(rating.histogram[3] == 1);
+    CHECK(rating.histogram[4] == 1);
+
+    // Once the table has every review, the next reload agrees with the replayed one
+    reconcileWith({{"rs-add-1", "rs-add-LL", 4}, {"rs-add-2", "rs-add-LL", 5}, {"rs-add-3", "rs-add-LL", 3}}, [] {});
+    CHECK(store.get("rs-add-LL").count == 3);
+    CHECK(store.get("rs-add-LL").sum == 12);
+}
+
+TEST_CASE("A review removed during a reconcile is ignored unless the reload has it", "[ratings]") {
+    RatingStore &store = RatingStore::instance();
+    reconcileWith({{"rs-remove-1", "rs-remove-LL", 4}, {"rs-remove-2", "rs-remove-LL", 2}, {"rs-remove-3", "rs-remove-LL", 5}},
+                  [&store] {
+        store.removeReview("rs-remove-gone", "rs-remove-LL", 4);  // deleted before the reload read the table
+        store.removeReview("rs-remove-2", "rs-remove-LL", 2);     // deleted after it
+    });
+    LandlordRating rating = store.get("rs-remove-LL");
+    CHECK(rating.count == 2);
+    CHECK(rating.sum == 9);
+    CHECK(rating.histogram[1] == 0);
+    CHECK(rating.histogram[3] == 1);
+    CHECK(rating.histogram[4] == 1);
+}
@@ -0,0 +1,170 @@
+#include "controllers/Catalog.h"
+#include "controllers/CatalogBuilder.h"
+#include "controllers/IdInterner.h"
+#include "controllers/NameIndex.h"
+#include "controllers/SuggestIndex.h"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    using Scores = std::vector<std::pair<double, uint32_t>>;
+
+    // Text from a small alphabet, so names and streets share prefixes at every depth
+    std::string randomText(std::mt19937 &rng, size_t maxLength) {
+        static const char *pieces[] = {"a", "b", "ab", "ba", "A", "B", " ", "-", "1", "\xc3\xa9"};
+        std::string text;
+        for(size_t i = 0, length = rng() % (maxLength + 1); i < length; i++) text += pieces[rng() % 10];
+        return text;
+    }
+
+    std::shared_ptr<Catalog> makeCatalog(const std::string &prefix, size_t landlordCount, std::mt19937 &rng,
+                                         std::string (*text)(std::mt19937 &, size_t)) {
+        CatalogBuilder builder;
+        for(size_t l = 0; l < landlordCount; l++) {
+            Landlord landlord;
+            landlord.landlordId = prefix + "LL" + std::to_string(l);
+            landlord.key = IdInterner::landlords().intern(landlord.landlordId);
+            landlord.name = text(rng, 8);
+            for(uint32_t p = 0, properties = rng() % 3; p < properties; p++) {
+                Property property;
+                property.propertyId = landlord.landlordId + "_P" + std::to_string(p);
+                property.key = IdInterner::properties().intern(property.propertyId);
+                property.street = text(rng, 6);
+                property.city = text(rng, 3);
+                builder.addProperty(landlord.key, std::move(property));
+            }
+            builder.addLandlord(std::move(landlord));
+        }
+        auto catalog = builder.join();
+        catalog->index();
+        return catalog;
+    }
+
+    // Ratings like real ones: few distinct averages and counts, so ties are common
+    Scores randomScores(size_t count, std::mt19937 &rng) {
+        Scores scores;
+        for(size_t i = 0; i < count; i++) scores.push_back({(rng() % 9) * 0.5 + 1, rng() % 4});
+        return scores;
+    }
+
+    void addWords(std::vector<std::string> &terms, const std::string &folded) {
+        size_t i = 0;
+        while(i < folded.size()) {
+            while(i < folded.size() && !std::isalnum(static_cast<unsigned char>(folded[i]))) i++;
+            size_t start = i;
+            while(i < folded.size() && std::isalnum(static_cast<unsigned char>(folded[i]))) i++;
+            if(i > start) terms.push_back(folded.substr(start, i - start));
+        }
+    }
+
+    // Every term of every landlord, as the index documents them: the folded full name, its
+    // words, and the words of the landlord's streets and cities
+    std::vector<std::vector<std::string>> allTerms(const Catalog &catalog) {
+        std::vector<std::vector<std::string>> terms(catalog.landlords.size());
+        for(uint32_t i = 0; i < catalog.landlords.size(); i++) {
+            const Landlord &landlord = catalog.landlords[i];
+            std::string name = NameIndex::fold(landlord.name);
+            if(!name.empty()) terms[i].push_back(name);
+            addWords(terms[i], name);
+            for(uint32_t p = landlord.firstProperty; p < landlord.firstProperty + landlord.propertyCount; p++) {
+                addWords(terms[i], NameIndex::fold(catalog.properties[p].street));
+                addWords(terms[i], NameIndex::fold(catalog.properties[p].city));
+            }
+        }
+        return terms;
+    }
+
+    // Every landlord with a term starting with prefix, best score first, then catalog order
+    std::vector<uint32_t> bruteForce(const std::vector<std::vector<std::string>> &terms, const Scores &scores,
+                                     const std::string &prefix, size_t limit) {
+        std::string folded = NameIndex::fold(prefix);
+        std::vector<uint32_t> matches;
+        for(uint32_t i = 0; i < terms.size(); i++) {
+            for(const auto &term : terms[i]) {
+                if(term.compare(0, folded.size(), folded) == 0) {
+                    matches.push_back(i);
+                    break;
+                }
+            }
+        }
+        std::stable_sort(matches.begin(), matches.end(), [&scores](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+        if(matches.size() > limit) matches.resize(limit);
+        return matches;
+    }
+}
+
+TEST_CASE("SuggestIndex returns the best ranked prefix matches of a brute-force scan", "[suggest]") {
+    std::mt19937 rng(18);
+    auto catalog = makeCatalog("suggest-", 1500, rng, randomText);
+    Scores scores = randomScores(catalog->landlords.size(), rng);
+    SuggestIndex index(*catalog, scores);
+    auto terms = allTerms(*catalog);
+
+    for(int q = 0; q < 3000; q++) {
+        // Prefixes cut from real terms, so most of them match, and some random ones
+        std::string prefix;
+        const auto &landlordTerms = terms[rng() % terms.size()];
+        if(q % 4 != 0 && !landlordTerms.empty()) {
+            const std::string &term = landlordTerms[rng() % landlordTerms.size()];
+            prefix = term.substr(0, rng() % (term.size() + 1));
+            if(rng() % 3 == 0) std::transform(prefix.begin(), prefix.end(), prefix.begin(), ::toupper);
+        } else {
+            prefix = randomText(rng, 4);
+        }
+        size_t limit = rng() % (SuggestIndex::TOP_K + 1);
+        INFO("prefix \"" << prefix << "\", limit " << limit);
+        REQUIRE(index.lookup(prefix, limit) == bruteForce(terms, scores, prefix, limit));
+    }
+}
+
+TEST_CASE("SuggestIndex handles empty catalogs and prefixes past every term", "[suggest]") {
+    Catalog empty;
+    empty.index();
+    SuggestIndex none(empty, {});
+    CHECK(none.lookup("", SuggestIndex::TOP_K).empty());
+    CHECK(none.lookup("a", SuggestIndex::TOP_K).empty());
+
+    std::mt19937 rng(19);
+    auto catalog = makeCatalog("suggest-edges-", 3, rng, [](std::mt19937 &, size_t) { return std::string("Maple Rentals"); });
+    Scores scores = {{3.0, 1}, {4.5, 2}, {4.5, 2}};
+    SuggestIndex index(*catalog, scores);
+    CHECK(index.lookup("REN", 10) == std::vector<uint32_t>{1, 2, 0});
+    CHECK(index.lookup("maple rentals", 10) == std::vector<uint32_t>{1, 2, 0});
+    CHECK(index.lookup("maple rentalsx", 10).empty());
+    CHECK(index.lookup("mapx", 10).empty());
+    CHECK(index.lookup("m", 1) == std::vector<uint32_t>{1});
+    CHECK(index.lookup("m", 0).empty());
+}
+
+TEST_CASE("Type-ahead over 100k landlords", "[.][benchmark][suggest]") {
+    std::mt19937 rng(20);
+    auto realistic = [](std::mt19937 &random, size_t) {
+        static const char *words[] = {"Maple", "Queen's", "Princess", "Limestone", "Frontenac", "Harbour",
+                                      "King", "Union", "Rentals", "Holdings", "Homes", "Realty"};
+        return std::string(words[random() % 12]) + " " + words[random() % 12] + " " + std::to_string(random() % 100000);
+    };
+    auto catalog = makeCatalog("bench-suggest-", 100000, rng, realistic);
+    Scores scores = randomScores(catalog->landlords.size(), rng);
+    auto terms = allTerms(*catalog);
+    SuggestIndex index(*catalog, scores);
+
+    BENCHMARK("build") {
+        SuggestIndex built(*catalog, scores);
+        return built.lookup("m", 1).size();
+    };
+    for(const char *prefix : {"m", "prin", "holdings", "1234"}) {
+        std::string label = std::string("\"") + prefix + "\"";
+        BENCHMARK("scan every term, " + label) {
+            return bruteForce(terms, scores, prefix, SuggestIndex::TOP_K);
+        };
+        BENCHMARK("trie lookup, " + label) {
+            return index.lookup(prefix, SuggestIndex::TOP_K);
+        };
+    }
+}
@@ -0,0 +1,266 @@
+#include "PostgrestStub.h"
+#include "controllers/Catalog.h"
+#include "controllers/RatingStore.h"
+#include "controllers/SupabaseHelper.h"
+#include <catch2/catch.hpp>
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace {
+    // Three small tables in PostgREST's row format. Names and addresses carry characters
+    // that need escaping, and one landlord has no properties
+    struct Dataset {
+        Json::Value landlords = Json::Value(Json::arrayValue);
+        Json::Value properties = Json::Value(Json::arrayValue);
+        Json::Value units = Json::Value(Json::arrayValue);
+
+        Dataset() {
+            for(int l = 0; l < 25; l++) {
+                Json::Value landlord(Json::objectValue);
+                landlord["landlord_id"] = "LL" + std::to_string(l);
+                landlord["name"] = l % 5 == 0 ? "O\"Brien \\ Sons " + std::to_string(l) : "Landlord \xc3\xa9" + std::to_string(l);
+                landlord["contact_email"] = "ll" + std::to_string(l) + "@example.com";
+                landlord["contact_phone"] = l % 3 == 0 ? Json::Value() : Json::Value("613-555-" + std::to_string(1000 + l));
+                landlords.append(landlord);
+                for(int p = 0; p < l % 4; p++) {
+                    Json::Value property(Json::objectValue);
+                    std::string propertyId = "P" + std::to_string(l) + "_" + std::to_string(p);
+                    property["property_id"] = propertyId;
+                    property["landlord_id"] = "LL" + std::to_string(l);
+                    property["street"] = std::to_string(10 + p) + " Princess St\nUnit";
+                    property["city"] = p % 2 ? "Kingston" : "Toronto";
+                    property["province"] = "ON";
+                    property["zip"] = "K7L " + std::to_string(p);
+                    properties.append(property);
+                    for(int u = 0; u < (l + p) % 3; u++) {
+                        Json::Value unit(Json::objectValue);
+                        unit["unit_id"] = static_cast<int>(units.size());
+                        unit["property_id"] = propertyId;
+                        unit["unit_number"] = std::to_string(100 + u);
+                        unit["bedrooms"] = u + 1;
+                        unit["bathrooms"] = u % 2 ? Json::Value(1.5) : Json::Value(1);
+                        unit["rent"] = u % 2 ? Json::Value(1450.5) : Json::Value(1200 + 100 * u);
+                        units.append(unit);
+                    }
+                }
+            }
+        }
+
+        // The embedded select: landlords with properties(units) nested
+        Json::Value embedded() const {
+            Json::Value out(Json::arrayValue);
+            for(const auto &landlord : landlords) {
+                Json::Value row = landlord;
+                row["properties"] = Json::Value(Json::arrayValue);
+                for(const auto &property : properties) {
+                    if(property["landlord_id"] != landlord["landlord_id"]) continue;
+                    Json::Value nested = property;
+                    nested.removeMember("landlord_id");
+                    nested["units"] = Json::Value(Json::arrayValue);
+                    for(const auto &unit : units) {
+                        if(unit["property_id"] != property["property_id"]) continue;
+                        Json::Value unitRow = unit;
+                        unitRow.removeMember("unit_id");
+                        unitRow.removeMember("property_id");
+                        nested["units"].append(unitRow);
+                    }
+                    row["properties"].append(nested);
+                }
+                out.append(row);
+            }
+            return out;
+        }
+    };
+
+    std::string compact(const Json::Value &value) {
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        return Json::writeString(writer, value);
+    }
+
+    bool startsWith(const std::string &text, const std::string &prefix) {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    // The catalog as the API returns it, one landlord after the other
+    std::string fetchCatalogJson() {
+        // Shared with the callback, which may still run after a timed out wait
+        auto result = std::make_shared<std::promise<std::string>>();
+        SupabaseHelper::getAllLandlords([result](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &err) {
+            if(!ok) {
+                result->set_value("error: " + err);
+                return;
+            }
+            Json::Value landlords(Json::arrayValue);
+            for(const auto &landlord : catalog->landlords) landlords.append(catalog->toJson(landlord));
+            result->set_value(compact(landlords));
+        });
+        auto future = result->get_future();
+        REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        return future.get();
+    }
+}
+
+TEST_CASE("Embedded and table-scan catalog fetches produce identical catalogs", "[supabase]") {
+    Dataset data;
+    std::string embeddedBody = compact(data.embedded());
+    std::atomic<bool> embeddedSupported{true};
+
+    PostgrestStub &server = PostgrestStub::shared([&](const std::string &method, const std::string &target) {
+        PostgrestStub::Reply reply;
+        if(method != "GET") return reply;
+        if(startsWith(target, "/rest/v1/landlords?") && target.find("properties(") != std::string::npos) {
+            if(!embeddedSupported) {
+                reply.status = 400;
+                reply.body = "{\"code\":\"PGRST200\",\"message\":\"Could not find a relationship\"}";
+                return reply;
+            }
+            reply.body = embeddedBody;
+        } else if(startsWith(target, "/rest/v1/landlords?")) {
+            reply.body = compact(data.landlords);
+        } else if(startsWith(target, "/rest/v1/properties?")) {
+            reply.body = compact(data.properties);
+        } else if(startsWith(target, "/rest/v1/units?")) {
+            reply.body = compact(data.units);
+        } else {
+            reply.status = 404;
+            reply.body = "{}";
+        }
+        return reply;
+    });
+
+    // Let any catalog cached by an earlier test expire
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    server.takeRequests();
+
+    std::string embedded = fetchCatalogJson();
+    std::vector<std::string> requests = server.takeRequests();
+    REQUIRE(requests.size() == 1);
+    CHECK(requests[0].find("properties(") != std::string::npos);
+
+    // The embedded select is rejected from now on, so the fetch falls back to the tables
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    embeddedSupported = false;
+    std::string tables = fetchCatalogJson();
+    requests = server.takeRequests();
+    CHECK(requests.size() == 4);
+
+    REQUIRE(!startsWith(embedded, "error"));
+    CHECK(tables == embedded);
+    CHECK(embedded.find("O\\\"Brien") != std::string::npos);
+    CHECK(embedded.find("1450.5") != std::string::npos);
+
+    // Publishing a snapshot ranks its landlords for the leaderboard
+    CHECK(RatingStore::instance().rankedCount() == data.landlords.size());
+}
+
+TEST_CASE("A catalog fetched before a landlord insert is not cached after it", "[supabase]") {
+    // The first catalog request is held until the insert below has completed, and answers
+    // with the catalog as it was before the insert; later requests see the new landlord.
+    // The state outlives the test case, as the stub may still be answering when it fails
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool firstArrived = false;
+        bool releaseFirst = false;
+        int catalogRequests = 0;
+
+        void release() {
+            std::lock_guard<std::mutex> lock(mutex);
+            releaseFirst = true;
+            changed.notify_all();
+        }
+    };
+    auto gate = std::make_shared<Gate>();
+    PostgrestStub &server = PostgrestStub::shared([gate](const std::string &method, const std::string &target) {
+        PostgrestStub::Reply reply;
+        if(method == "POST") {
+            reply.status = 201;
+            return reply;
+        }
+        if(!startsWith(target, "/rest/v1/landlords?")) return reply;
+        std::unique_lock<std::mutex> lock(gate->mutex);
+        bool first = gate->catalogRequests++ == 0;
+        if(first) {
+            gate->firstArrived = true;
+            gate->changed.notify_all();
+            gate->changed.wait_for(lock, std::chrono::seconds(30), [&] { return gate->releaseFirst; });
+        }
+        reply.body = first ? R"([{"landlord_id":"gen-LL1","name":"Before"}])"
+                           : R"([{"landlord_id":"gen-LL1","name":"Before"},{"landlord_id":"gen-LL2","name":"After"}])";
+        return reply;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    server.takeRequests();
+
+    auto before = std::make_shared<std::promise<size_t>>();
+    SupabaseHelper::getAllLandlords([before](bool ok, const std::shared_ptr<const Catalog> &catalog, const std::string &) {
+        before->set_value(ok ? catalog->landlords.size() : 0);
+    });
+    {
+        std::unique_lock<std::mutex> lock(gate->mutex);
+        REQUIRE(gate->changed.wait_for(lock, std::chrono::seconds(10), [&] { return gate->firstArrived; }));
+    }
+
+    auto inserted = std::make_shared<std::promise<bool>>();
+    SupabaseHelper::insertLandlord("gen-LL2", "After", "", "", Json::Value(Json::arrayValue),
+                                   [inserted](bool ok, const std::string &) { inserted->set_value(ok); });
+    REQUIRE(inserted->get_future().get());
+
+    // Arrives while the pre-insert fetch is still running, and must not share it
+    std::string during = fetchCatalogJson();
+    gate->release();
+    CHECK(during.find("After") != std::string::npos);
+    CHECK(before->get_future().get() == 1);
+    // The dropped snapshot is not ranked either
+    CHECK(RatingStore::instance().rankedCount() == 2);
+
+    // The old result was dropped rather than cached over the new one
+    std::string after = fetchCatalogJson();
+    CHECK(after == during);
+    std::lock_guard<std::mutex> lock(gate->mutex);
+    CHECK(gate->catalogRequests == 2);
+}
+
+TEST_CASE("Landlord stats fail when any table cannot be counted", "[supabase]") {
+    std::atomic<bool> unitsFail{true};
+    PostgrestStub &server = PostgrestStub::shared([&](const std::string &method, const std::string &target) {
+        PostgrestStub::Reply reply;
+        if(method != "HEAD") return reply;
+        if(startsWith(target, "/rest/v1/units?") && unitsFail) {
+            reply.status = 500;
+            return reply;
+        }
+        reply.headers = startsWith(target, "/rest/v1/landlords?") ? "Content-Range: 0-24/25\r\n"
+                        : startsWith(target, "/rest/v1/properties?") ? "Content-Range: */37\r\n"
+                        : "Content-Range: 0-9/52\r\n";
+        return reply;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    server.takeRequests();
+
+    auto fetchStats = [] {
+        auto result = std::make_shared<std::promise<std::string>>();
+        SupabaseHelper::getLandlordStats([result](bool ok, const Json::Value &counts, const std::string &err) {
+            result->set_value(ok ? compact(counts) : "error: " + err);
+        });
+        auto future = result->get_future();
+        REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        return future.get();
+    };
+
+    // Two good counts do not make an answer with zero units
+    std::string partial = fetchStats();
+    CHECK(startsWith(partial, "error: units count failed"));
+    CHECK(server.takeRequests().size() == 3);
+
+    // Nothing was cached, so the next call counts again
+    unitsFail = false;
+    CHECK(fetchStats() == R"({"landlords":25,"properties":37,"units":52})");
+    CHECK(server.takeRequests().size() == 3);
+}
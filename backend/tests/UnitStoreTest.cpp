@@ -0,0 +1,145 @@
+#include "controllers/Catalog.h"
+#include "controllers/CatalogBuilder.h"
+#include "controllers/IdInterner.h"
+#include "controllers/UnitStore.h"
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    std::shared_ptr<Catalog> randomCatalog(const std::string &prefix, size_t landlordCount, std::mt19937 &rng) {
+        static const char *cities[] = {"Kingston", "KINGSTON", "Toronto", "Ottawa", "Napanee", ""};
+        static const char *provinces[] = {"ON", "on", "QC"};
+        CatalogBuilder builder;
+        for(size_t l = 0; l < landlordCount; l++) {
+            Landlord landlord;
+            landlord.landlordId = prefix + "LL" + std::to_string(l);
+            landlord.key = IdInterner::landlords().intern(landlord.landlordId);
+            for(uint32_t p = 0, properties = rng() % 4; p < properties; p++) {
+                Property property;
+                property.propertyId = landlord.landlordId + "_P" + std::to_string(p);
+                property.key = IdInterner::properties().intern(property.propertyId);
+                property.city = cities[rng() % 6];
+                property.province = provinces[rng() % 3];
+                for(uint32_t u = 0, units = rng() % 5; u < units; u++) {
+                    Unit unit;
+                    unit.bedrooms = static_cast<int>(rng() % 7) - 1;
+                    unit.bathrooms = (rng() % 7) * 0.5;
+                    unit.rent = rng() % 8 ? (50000 + rng() % 300000) / 100.0 : (rng() % 2 ? -5.0 : 1450.255);
+                    builder.addUnit(property.key, std::move(unit));
+                }
+                builder.addProperty(landlord.key, std::move(property));
+            }
+            builder.addLandlord(std::move(landlord));
+        }
+        auto catalog = builder.join();
+        catalog->index();
+        return catalog;
+    }
+
+    std::string lower(std::string text) {
+        for(char &c : text) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return text;
+    }
+
+    uint32_t cents(double rent) {
+        return rent <= 0 ? 0 : static_cast<uint32_t>(std::llround(rent * 100));
+    }
+}
+
+TEST_CASE("UnitStore columns hold each unit of the catalog", "[units]") {
+    std::mt19937 rng(24);
+    auto catalog = randomCatalog("unit-store-", 500, rng);
+    const UnitStore &store = catalog->unitStore();
+    REQUIRE(store.size() == catalog->units.size());
+
+    for(uint32_t l = 0; l < catalog->landlords.size(); l++) {
+        const Landlord &landlord = catalog->landlords[l];
+        for(uint32_t p = landlord.firstProperty; p < landlord.firstProperty + landlord.propertyCount; p++) {
+            const Property &property = catalog->properties[p];
+            CHECK(store.propertyLandlord[p] == l);
+            for(uint32_t u = property.firstUnit; u < property.firstUnit + property.unitCount; u++) {
+                const Unit &unit = catalog->units[u];
+                REQUIRE(store.property[u] == p);
+                REQUIRE(lower(store.cities()[store.cityId[u]]) == lower(property.city));
+                REQUIRE(lower(store.provinces()[store.provinceId[u]]) == lower(property.province));
+                REQUIRE(store.bedrooms[u] == std::max(unit.bedrooms, 0));
+                REQUIRE(store.bathroomTenths[u] == static_cast<uint16_t>(std::lround(unit.bathrooms * 10)));
+                REQUIRE(store.rentCents[u] == cents(unit.rent));
+            }
+        }
+    }
+
+    // One dictionary entry per name ignoring case, spelled as first seen
+    CHECK(store.cities().size() == 5);
+    CHECK(store.provinces().size() == 2);
+    CHECK(store.findCity("kINGSTON") == store.findCity("Kingston"));
+    CHECK(store.findCity("") != UnitStore::NONE);
+    CHECK(store.findCity("Montreal") == UnitStore::NONE);
+    CHECK(store.findProvince("qc") != UnitStore::NONE);
+}
+
+TEST_CASE("UnitStore city stats match a scan of the columns", "[units]") {
+    std::mt19937 rng(25);
+    auto catalog = randomCatalog("unit-stats-", 500, rng);
+    const UnitStore &store = catalog->unitStore();
+
+    std::map<uint32_t, UnitStore::CityStats> expected;
+    for(uint32_t u = 0; u < store.size(); u++) {
+        UnitStore::CityStats &city = expected[store.cityId[u]];
+        uint32_t rent = store.rentCents[u];
+        city.minRentCents = city.units == 0 ? rent : std::min(city.minRentCents, rent);
+        city.maxRentCents = city.units == 0 ? rent : std::max(city.maxRentCents, rent);
+        city.rentCentsSum += rent;
+        city.units++;
+    }
+    std::vector<UnitStore::CityStats> stats = store.cityStats();
+    REQUIRE(stats.size() == store.cities().size());
+    for(uint32_t c = 0; c < stats.size(); c++) {
+        INFO(store.cities()[c]);
+        const UnitStore::CityStats &want = expected[c];
+        CHECK(stats[c].units == want.units);
+        CHECK(stats[c].rentCentsSum == want.rentCentsSum);
+        CHECK(stats[c].minRentCents == want.minRentCents);
+        CHECK(stats[c].maxRentCents == want.maxRentCents);
+    }
+}
+
+TEST_CASE("Property stats over 100k units", "[.][benchmark][units]") {
+    std::mt19937 rng(26);
+    auto catalog = randomCatalog("bench-units-", 40000, rng);
+    const UnitStore &store = catalog->unitStore();
+
+    // What the stats endpoint walked before the columns: landlords, properties and units as structs
+    BENCHMARK("city stats from the catalog structs") {
+        std::map<std::string, UnitStore::CityStats> stats;
+        for(const auto &landlord : catalog->landlords) {
+            for(uint32_t p = landlord.firstProperty; p < landlord.firstProperty + landlord.propertyCount; p++) {
+                const Property &property = catalog->properties[p];
+                UnitStore::CityStats &city = stats[lower(property.city)];
+                for(uint32_t u = property.firstUnit; u < property.firstUnit + property.unitCount; u++) {
+                    uint32_t rent = cents(catalog->units[u].rent);
+                    city.minRentCents = city.units == 0 ? rent : std::min(city.minRentCents, rent);
+                    city.maxRentCents = city.units == 0 ? rent : std::max(city.maxRentCents, rent);
+                    city.rentCentsSum += rent;
+                    city.units++;
+                }
+            }
+        }
+        return stats.size();
+    };
+    BENCHMARK("city stats from the columns") {
+        return store.cityStats().size();
+    };
+    BENCHMARK("build") {
+        UnitStore built;
+        built.build(*catalog);
+        return built.size();
+    };
+}